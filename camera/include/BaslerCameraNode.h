@@ -1,6 +1,7 @@
 #pragma once
 
 #include "BaslerCameraBase.h"
+#include "GrabBuffer.h"
 #include "ImageDataRaw.h"
 #include "Pusher.h"
 
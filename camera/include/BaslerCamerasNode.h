@@ -7,12 +7,43 @@
 #include <boost/multi_index/ordered_index.hpp>
 #include <boost/multi_index_container.hpp>
 #include <chrono>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <stop_token>
+#include <thread>
+#include <vector>
 
 #include "BaslerCameraBase.h"
+#include "GrabBuffer.h"
 #include "ImageDataRaw.h"
+#include "LatencyTracer.h"
 #include "Pusher.h"
+#include "ThreadPlacement.h"
+#include "TimestampMerge.h"
 #include "common_output.h"
 
+/**
+ * @brief How the images of the cameras are retrieved.
+ */
+enum class GrabMode {
+	shared,      ///< one loop retrieves the images of all cameras in the thread that calls push
+	per_camera,  ///< every camera has its own grab thread, the images are merged in timestamp order in the thread that calls push
+};
+
+/**
+ * @brief The grab statistics of one camera, updated lock-free by the thread that grabs the camera.
+ */
+struct GrabStatistics {
+	std::atomic<std::uint64_t> grabbed = 0;         // images retrieved successfully
+	std::atomic<std::uint64_t> failed = 0;          // grabs that did not succeed
+	std::atomic<std::uint64_t> dropped = 0;         // images evicted unmerged because the merge fell behind
+	std::atomic<std::uint64_t> last_timestamp = 0;  // camera timestamp of the last image
+	LatencyHistogram frame_interval;                // between the camera timestamps of consecutive images
+	LatencyHistogram grab_latency;                  // from the camera timestamp until the image was retrieved
+};
+
 /**
  * @class BaslerCamerasNode
  * @brief Manages multiple Basler cameras.
@@ -48,12 +79,33 @@ class BaslerCamerasNode : public Pusher<ImageDataRaw>, public BaslerCameraBase<v
 	 * Then configures ptp and initialize image grabbing with the specified cameras, that were also found.
 	 *
 	 * @param camera_name_mac_address A map which specifies the different cameras with their mac addresses that should perform image capture.
+	 * @param grab_thread_placement The placement of the thread that grabs the images, e.g. SCHED_FIFO on a dedicated core. It is applied on the first grab.
+	 * @param downstream_queue_depth The maximum number of images of one camera the pipeline holds at once, the grab buffers are sized accordingly since the images reference them without a copy.
+	 * @param grab_mode Whether the cameras are retrieved in one loop or each in its own thread. The placement applies to every grab thread.
 	 */
-	explicit BaslerCamerasNode(std::map<std::string, MacAddressConfig>&& camera_name_mac_address);
+	explicit BaslerCamerasNode(std::map<std::string, MacAddressConfig>&& camera_name_mac_address, std::optional<ThreadPlacementConfig> grab_thread_placement = std::nullopt, std::size_t downstream_queue_depth = 4,
+	    GrabMode grab_mode = GrabMode::shared);
+
+	/**
+	 * @brief Prints the grab statistics of every camera, i.e. the frame rate, the grab latency and the failed and dropped images.
+	 */
+	void print_statistics() const;
 
    private:
 	Pylon::CBaslerUniversalInstantCameraArray _cameras;
 
+	std::optional<ThreadPlacementConfig> _grab_thread_placement;
+	std::once_flag _grab_thread_placed;
+
+	GrabMode const _grab_mode;
+	std::vector<std::unique_ptr<GrabStatistics>> _statistics;
+
+	// per camera mode: the grab threads hand their images to the merge, which releases them in timestamp order
+	static constexpr std::chrono::milliseconds merge_window = 20ms;  // how long an image waits for older images of lagging cameras
+	static constexpr std::size_t merge_queue_depth = 3;              // images of one camera waiting for the merge, the oldest is evicted if another one arrives
+	std::optional<TimestampMerge<ImageDataRaw>> _merge;
+	std::optional<std::stop_callback<std::function<void()>>> _close_on_stop;
+
 	/**
 	 * Container for camera indexing based on name and MAC address and index in BaslerUniversalInstantCameraArray.
 	 */
@@ -65,6 +117,20 @@ class BaslerCamerasNode : public Pusher<ImageDataRaw>, public BaslerCameraBase<v
 	                                                                      boost::multi_index::member<CameraNameMacAddressIndexConfig, int, &CameraNameMacAddressIndexConfig::index>>>>
 	    _camera_name_mac_address_index_map;
 
+	// declared last, so that the grab threads are stopped before anything they use is destroyed
+	std::vector<std::jthread> _grab_threads;
+
+	/**
+	 * @brief Turns a grab result into an image and updates the statistics of the camera.
+	 * @return The image, if the grab succeeded.
+	 */
+	std::optional<ImageDataRaw> to_image(Pylon::CGrabResultPtr const& grab_result, CameraNameMacAddressIndexConfig const& config);
+
+	/**
+	 * @brief Retrieves the images of one camera until the node is destroyed.
+	 */
+	void grab_loop(std::stop_token const& stop, CameraNameMacAddressIndexConfig const& config);
+
 	/**
 	 * @brief Captures and processes images from the cameras.
 	 * @return Captured image data in the form of ImageDataRaw.
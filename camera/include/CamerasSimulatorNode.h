@@ -1,16 +1,26 @@
 #pragma once
 
+#include <tbb/task_group.h>
+
+#include <atomic>
 #include <cstdint>
+#include <deque>
 #include <filesystem>
 #include <fstream>
 #include <functional>
+#include <future>
 #include <map>
-#include <regex>
+#include <memory>
+#include <optional>
+#include <queue>
 #include <utility>
 
+#include "DatasetIndex.h"
+#include "DecodedFrameCache.h"
 #include "ImageData.h"
 #include "ImageDataRaw.h"
 #include "Pusher.h"
+#include "ReplayClock.h"
 #include "common_output.h"
 
 /**
@@ -19,6 +29,8 @@
  *
  * This class is set up with image files, their source camera and timestamps.
  * The class then pushes out the image data as it was obtained when the data was recorded.
+ * The next images are decoded ahead in parallel with TBB, so that the decoding does not delay the delivery of an image.
+ * Optionally, the decoded images are cached for the next passes over the recording.
  */
 class CamerasSimulatorNode : public Pusher<ImageData> {
    public:
@@ -29,92 +41,105 @@ class CamerasSimulatorNode : public Pusher<ImageData> {
 		std::string source;
 	};
 
-	explicit CamerasSimulatorNode(std::vector<FilepathArrivedRecordedSourceConfig>&& files);
+	explicit CamerasSimulatorNode(std::vector<FilepathArrivedRecordedSourceConfig>&& files, ReplayConfig const& replay = {});
+	CamerasSimulatorNode(CamerasSimulatorNode&&) = default;
+	~CamerasSimulatorNode();
+
+	/**
+	 * @brief Prints the statistics of the decoded frame cache, if the cache is enabled.
+	 */
+	void print_cache_statistics() const;
+
+	/**
+	 * @return The statistics of the decoded frame cache or std::nullopt, if the cache is disabled.
+	 */
+	[[nodiscard]] std::optional<DecodedFrameCacheStatistics> cache_statistics() const;
 
    private:
 	ImageData push() final;
 
+	/**
+	 * @brief Decodes one image exactly once, either in a TBB worker thread or in the thread that needs the image first.
+	 */
+	struct Decode {
+		std::atomic_flag started;
+		std::packaged_task<cv::Mat()> task;
+
+		void operator()() {
+			if (!started.test_and_set()) task();
+		}
+	};
+
+	struct PrefetchedImage {
+		FilepathArrivedRecordedSourceConfig file;
+		bool first_of_pass;
+		std::shared_ptr<Decode> decode;
+		std::future<cv::Mat> image;
+	};
+
+	void prefetch();
+
 	struct sorting_function {
 		bool operator()(FilepathArrivedRecordedSourceConfig const& lhs, FilepathArrivedRecordedSourceConfig const& rhs) const { return lhs.arrived > rhs.arrived; }
 	};
 
 	std::vector<FilepathArrivedRecordedSourceConfig> _files;
-	std::chrono::time_point<std::chrono::system_clock> _images_time;
-	std::chrono::time_point<std::chrono::system_clock> _current_time;
+	ReplayClock _clock;
 	std::priority_queue<FilepathArrivedRecordedSourceConfig, std::vector<FilepathArrivedRecordedSourceConfig>, sorting_function> _queue;
+
+	std::unique_ptr<DecodedFrameCache> _cache;
+	std::deque<PrefetchedImage> _prefetched;
+	std::unique_ptr<tbb::task_group> _decoders = std::make_unique<tbb::task_group>();
 };
 
 /**
- * @brief Factory method that takes a camera name and a folder containing recoded images for each camera to simulate.
+ * @brief Factory method that takes a camera name and a folder containing recoded images for each camera to simulate, see index_dataset.
  *
  * @attention Expects the files to be in the format <timestamp of image arrival in ns>_<timestamp of image recording in ns>.
  *
+ * @param replay Whether the recording is replayed in real time, scaled or as fast as possible.
  * @return The CamerasSimulatorNode class which simulates the defined cameras.
  */
-inline CamerasSimulatorNode make_cameras_simulator_node_arrived_recorded1(std::map<std::string, std::filesystem::path>&& folders) {
+inline CamerasSimulatorNode make_cameras_simulator_node_arrived_recorded1(std::map<std::string, std::filesystem::path>&& folders, ReplayConfig const& replay = {}) {
 	std::vector<CamerasSimulatorNode::FilepathArrivedRecordedSourceConfig> ret;
-
-	for (auto const& [source, folder] : folders) {
-		for (auto const& file : std::filesystem::directory_iterator(folder)) {
-			static std::regex const timestamp("([0-9]+)_([0-9]+)");
-			std::cmatch m;
-			std::string regex_string = file.path().filename();
-			std::regex_match(regex_string.c_str(), m, timestamp);
-
-			ret.emplace_back(file.path(), std::stoull(m[1].str()), std::stoull(m[2].str()), source);
-		}
-	}
+	for (auto& [filepath, arrived, recorded, source] : index_dataset({folders.begin(), folders.end()}, DatasetFileNames::arrived_recorded)) ret.emplace_back(std::move(filepath), arrived, recorded, std::move(source));
 
 	if (ret.empty()) common::println_critical_loc("No image files found!");
 
-	return CamerasSimulatorNode{std::move(ret)};
+	return CamerasSimulatorNode{std::move(ret), replay};
 }
 
 /**
- * @brief Factory method that takes a camera name and a folder containing recoded images for each camera to simulate.
+ * @brief Factory method that takes a camera name and a folder containing recoded images for each camera to simulate, see index_dataset.
  *
  * @attention Expects the files to be in the format <timestamp of image arrival in ns>(.png|.jpeg|...).
  *
+ * @param replay Whether the recording is replayed in real time, scaled or as fast as possible.
  * @return The CamerasSimulatorNode class which simulates the defined cameras.
  */
-inline CamerasSimulatorNode make_cameras_simulator_node_arrived1(std::map<std::string, std::filesystem::path>&& folders) {
+inline CamerasSimulatorNode make_cameras_simulator_node_arrived1(std::map<std::string, std::filesystem::path>&& folders, ReplayConfig const& replay = {}) {
 	std::vector<CamerasSimulatorNode::FilepathArrivedRecordedSourceConfig> ret;
-
-	for (auto const& [source, folder] : folders) {
-		for (auto const& file : std::filesystem::directory_iterator(folder)) {
-			ret.emplace_back(file.path(), std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::milliseconds(std::stoull(file.path().stem()))).count(),
-			    std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::milliseconds(std::stoull(file.path().stem()))).count(), source);
-		}
-	}
+	for (auto& [filepath, arrived, recorded, source] : index_dataset({folders.begin(), folders.end()}, DatasetFileNames::arrived_milliseconds)) ret.emplace_back(std::move(filepath), arrived, recorded, std::move(source));
 
 	if (ret.empty()) common::println_critical_loc("No image files found!");
 
-	return CamerasSimulatorNode{std::forward<decltype(ret)>(ret)};
+	return CamerasSimulatorNode{std::forward<decltype(ret)>(ret), replay};
 }
 
 /**
- * @brief Factory method that takes a camera name and a folder containing tumtraf images.
+ * @brief Factory method that takes a camera name and a folder containing tumtraf images, see index_dataset.
  *
  * @attention Expects the files to be in the tumtraffic format.
  * @attention Unfortunately, the timestamps of the recording are sometimes a little bit off. It looks like it is buggy, but it is not the case.
  *
+ * @param replay Whether the recording is replayed in real time, scaled or as fast as possible.
  * @return The CamerasSimulatorNode class which simulates the defined cameras.
  */
-inline CamerasSimulatorNode make_cameras_simulator_node_tumtraf(std::multimap<std::string, std::filesystem::path>&& folders) {
+inline CamerasSimulatorNode make_cameras_simulator_node_tumtraf(std::multimap<std::string, std::filesystem::path>&& folders, ReplayConfig const& replay = {}) {
 	std::vector<CamerasSimulatorNode::FilepathArrivedRecordedSourceConfig> ret;
-
-	for (auto const& [source, folder] : folders) {
-		for (auto const& file : std::filesystem::directory_iterator(folder)) {
-			static std::regex const timestamp("([0-9]+)_([0-9]+)_(s110_camera_basler_(north|east|south(1|2))_8mm|vehicle_camera_basler_16mm).jpg");
-			std::cmatch m;
-			std::string regex_string = file.path().filename();
-			std::regex_match(regex_string.c_str(), m, timestamp);
-
-			ret.emplace_back(file.path(), std::stoull(m[1].str() + m[2].str()), std::stoull(m[1].str() + m[2].str()), source);
-		}
-	}
+	for (auto& [filepath, arrived, recorded, source] : index_dataset({folders.begin(), folders.end()}, DatasetFileNames::tumtraf)) ret.emplace_back(std::move(filepath), arrived, recorded, std::move(source));
 
 	if (ret.empty()) common::println_critical_loc("No image files found!");
 
-	return CamerasSimulatorNode{std::move(ret)};
+	return CamerasSimulatorNode{std::move(ret), replay};
 }
\ No newline at end of file
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief The naming schemes of recorded image files.
+ */
+enum class DatasetFileNames {
+	arrived_recorded,      ///< <timestamp of image arrival in ns>_<timestamp of image recording in ns>
+	arrived_milliseconds,  ///< <timestamp of image arrival in ms>(.png|.jpeg|...)
+	tumtraf,               ///< <seconds>_<nanoseconds>_<camera name>.jpg as in the TUMTraf datasets
+};
+
+/**
+ * @brief A recorded image file with its timestamps.
+ */
+struct DatasetFile {
+	std::filesystem::path filepath;
+	std::uint64_t arrived;
+	std::uint64_t recorded;
+	std::string source;
+};
+
+/**
+ * @brief Lists the images files of the folders with their timestamps.
+ *
+ * The folders are scanned in parallel and the file names are parsed without regex.
+ * The result of each scan is stored in a binary manifest next to the folder, i.e. <folder>.<naming scheme>.manifest.
+ * As long as the modification time of the folder does not change, later calls memory-map the manifest instead of scanning the folder.
+ * Files that do not match the naming scheme are skipped with a warning.
+ *
+ * @param folders The source camera and the folder of its images, a source may have several folders.
+ * @param names The naming scheme of the files.
+ * @param use_manifests Whether manifests are read and written.
+ * @return The image files of all folders.
+ */
+std::vector<DatasetFile> index_dataset(std::vector<std::pair<std::string, std::filesystem::path>> const& folders, DatasetFileNames names, bool use_manifests = true);
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <mutex>
+#include <opencv2/opencv.hpp>
+#include <optional>
+#include <string>
+#include <unordered_map>
+
+/**
+ * @brief A snapshot of the counters and the memory usage of a DecodedFrameCache.
+ */
+struct DecodedFrameCacheStatistics {
+	std::uint64_t hits = 0;             ///< Number of images found as they were decoded.
+	std::uint64_t compressed_hits = 0;  ///< Number of images found in the compressed form.
+	std::uint64_t misses = 0;           ///< Number of images that had to be decoded.
+	std::uint64_t rejected = 0;         ///< Number of images that did not fit into the budget.
+	std::size_t frames = 0;             ///< Number of cached images.
+	std::size_t used = 0;               ///< Bytes the cached images take.
+	std::size_t budget = 0;             ///< Bytes the cached images may take.
+};
+
+/**
+ * @class DecodedFrameCache
+ * @brief Keeps decoded images of a looping replay in memory within a memory budget, so that they are only decoded on the first pass.
+ *
+ * In a looping replay, the frame that was decoded last is the one needed furthest in the future.
+ * Thus, the optimal eviction (Belady) evicts the new frame instead of a cached one, which LRU would do and then miss on every access.
+ * If a new frame does not fit into the budget anymore, it is stored as I420 which takes half the memory and is cheap to convert back.
+ * JPEG images are usually chroma subsampled the same way, so this loses next to nothing.
+ * If it does not fit in this form either, it is not cached.
+ */
+class DecodedFrameCache {
+	struct Entry {
+		cv::Mat image;
+		bool compressed;
+	};
+
+	std::size_t const _budget;
+
+	mutable std::mutex _mutex;
+	std::unordered_map<std::string, Entry> _entries;
+	std::size_t _used = 0;
+
+	mutable std::atomic<std::uint64_t> _hits = 0;
+	mutable std::atomic<std::uint64_t> _compressed_hits = 0;
+	mutable std::atomic<std::uint64_t> _misses = 0;
+	std::atomic<std::uint64_t> _rejected = 0;
+
+   public:
+	/**
+	 * @param budget The maximum number of bytes the cached images may take.
+	 */
+	explicit DecodedFrameCache(std::size_t budget);
+
+	/**
+	 * @brief Returns a copy of the cached image that the caller may modify. Can be called from any thread.
+	 *
+	 * @param path The file the image was decoded from.
+	 */
+	[[nodiscard]] std::optional<cv::Mat> find(std::filesystem::path const& path) const;
+
+	/**
+	 * @brief Caches the decoded image, as it is, compressed or not at all, depending on the remaining budget. Can be called from any thread.
+	 *
+	 * @param path The file the image was decoded from.
+	 * @param image The decoded BGR image.
+	 */
+	void insert(std::filesystem::path const& path, cv::Mat const& image);
+
+	/**
+	 * @brief Returns the current counters and memory usage. Can be called from any thread.
+	 */
+	[[nodiscard]] DecodedFrameCacheStatistics statistics() const;
+
+	/**
+	 * @brief Prints the hit rate and the memory usage.
+	 */
+	void print_statistics() const;
+};
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <utility>
+
+#include "RawBuffer.h"
+
+/**
+ * @brief Wraps the buffer of a grab result into a RawBuffer without copying.
+ *
+ * The handle, e.g. a Pylon::CGrabResultPtr, is kept alive until the last copy of the raw image is destroyed.
+ * Only then the grab provider can reuse the buffer, so the raw bytes can flow from the camera to the demosaicing without a copy.
+ *
+ * @param handle The handle that owns the buffer on behalf of the grab provider.
+ * @param data The first byte of the buffer.
+ * @param size The size of the buffer.
+ * @return The raw image viewing the buffer.
+ */
+template <typename Handle>
+RawBuffer make_grab_buffer(Handle handle, void const* data, std::size_t const size) {
+	return RawBuffer(std::make_shared<Handle const>(std::move(handle)), static_cast<std::uint8_t const*>(data), size);
+}
+
+/**
+ * @brief Returns the number of buffers a camera needs, so that it does not run dry while the pipeline holds images of it.
+ *
+ * Besides the images in the downstream queue, one buffer is filled by the camera and one waits to be retrieved.
+ *
+ * @param downstream_queue_depth The maximum number of images of the camera the pipeline holds at once.
+ */
+constexpr std::size_t grab_buffer_count(std::size_t const downstream_queue_depth) { return downstream_queue_depth + 2; }
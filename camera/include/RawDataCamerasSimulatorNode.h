@@ -7,11 +7,12 @@
 #include <fstream>
 #include <functional>
 #include <map>
-#include <regex>
 
+#include "DatasetIndex.h"
 #include "ImageData.h"
 #include "ImageDataRaw.h"
 #include "Pusher.h"
+#include "ReplayClock.h"
 
 /**
  * @class RawDataCamerasSimulatorNode
@@ -29,7 +30,7 @@ class RawDataCamerasSimulatorNode : public Pusher<ImageDataRaw> {
 		std::string source;
 	};
 
-	explicit RawDataCamerasSimulatorNode(std::vector<FilepathArrivedRecordedSourceConfig>&& files);
+	explicit RawDataCamerasSimulatorNode(std::vector<FilepathArrivedRecordedSourceConfig>&& files, ReplayConfig const& replay = {});
 
    private:
 	ImageDataRaw push() final;
@@ -39,33 +40,23 @@ class RawDataCamerasSimulatorNode : public Pusher<ImageDataRaw> {
 	};
 
 	std::vector<FilepathArrivedRecordedSourceConfig> _files;
-	std::chrono::time_point<std::chrono::system_clock> _images_time;
-	std::chrono::time_point<std::chrono::system_clock> _current_time;
+	ReplayClock _clock;
 	std::priority_queue<FilepathArrivedRecordedSourceConfig, std::vector<FilepathArrivedRecordedSourceConfig>, sorting_function> _queue;
 };
 
 /**
- * @brief Factory method that takes a camera name and a folder containing recoded raw images for each camera to simulate.
+ * @brief Factory method that takes a camera name and a folder containing recoded raw images for each camera to simulate, see index_dataset.
  *
  * @attention Expects the files to be in the format <timestamp of image arrival in ns>_<timestamp of image recording in ns>.
  *
+ * @param replay Whether the recording is replayed in real time, scaled or as fast as possible.
  * @return The RawDataCamerasSimulatorNode class which simulates the defined cameras.
  */
-inline RawDataCamerasSimulatorNode make_raw_data_cameras_simulator_node_arrived_recorded1(std::map<std::string, std::filesystem::path>&& folders) {
+inline RawDataCamerasSimulatorNode make_raw_data_cameras_simulator_node_arrived_recorded1(std::map<std::string, std::filesystem::path>&& folders, ReplayConfig const& replay = {}) {
 	std::vector<RawDataCamerasSimulatorNode::FilepathArrivedRecordedSourceConfig> ret;
-
-	for (auto const& [source, folder] : folders) {
-		for (auto const& file : std::filesystem::directory_iterator(folder)) {
-			static std::regex const timestamp("([0-9]+)_([0-9]+)");
-			std::cmatch m;
-			std::string regex_string = file.path().filename();
-			std::regex_match(regex_string.c_str(), m, timestamp);
-
-			ret.emplace_back(file.path(), std::stoull(m[1].str()), std::stoull(m[2].str()), source);
-		}
-	}
+	for (auto& [filepath, arrived, recorded, source] : index_dataset({folders.begin(), folders.end()}, DatasetFileNames::arrived_recorded)) ret.emplace_back(std::move(filepath), arrived, recorded, std::move(source));
 
 	if (ret.empty()) common::println_critical_loc("No image files found!");
 
-	return RawDataCamerasSimulatorNode{std::forward<decltype(ret)>(ret)};
+	return RawDataCamerasSimulatorNode{std::forward<decltype(ret)>(ret), replay};
 }
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <cstddef>
+#include <filesystem>
+
+#include "ImageDataRaw.h"
+#include "Pusher.h"
+#include "RawRecording.h"
+#include "ReplayClock.h"
+
+/**
+ * @class RawRecordingCamerasSimulatorNode
+ * @brief Simulates multiple cameras to push raw images from a segmented recording written by RawRecordingSavingNode.
+ *
+ * The frames are handed out as views into the memory-mapped segments, so replaying them does not copy a single byte.
+ */
+class RawRecordingCamerasSimulatorNode : public Pusher<ImageDataRaw> {
+	RawRecordingReader _recording;
+	ReplayClock _clock;
+	std::size_t _next = 0;
+
+	ImageDataRaw push() final;
+
+   public:
+	/**
+	 * @param folder The folder of the recording.
+	 * @param replay Whether the recording is replayed in real time, scaled or as fast as possible.
+	 */
+	explicit RawRecordingCamerasSimulatorNode(std::filesystem::path const& folder, ReplayConfig const& replay = {});
+};
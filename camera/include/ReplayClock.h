@@ -0,0 +1,71 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @brief How a recording is replayed by the camera simulators.
+ */
+enum class ReplayMode {
+	real_time,            ///< the images are pushed with the same gaps as they arrived when they were recorded, divided by the time scale
+	as_fast_as_possible,  ///< the images are pushed as soon as they are read, the pace is set by the backpressure of the pipeline
+};
+
+/**
+ * @brief Describes how a recording is replayed.
+ */
+struct ReplayConfig {
+	ReplayMode mode = ReplayMode::real_time;  // pacing of the images
+	double time_scale = 1.;                   // speed of the replay in real time mode, e.g. 0.5 for half and 10 for ten times the speed
+	std::size_t prefetch_depth = 8;           // number of images CamerasSimulatorNode decodes ahead in parallel, 0 decodes on the critical path
+	std::size_t cache_budget = 0;             // bytes of decoded images CamerasSimulatorNode keeps for the next passes, 0 decodes them again on every pass
+};
+
+/**
+ * @class ReplayClock
+ * @brief Paces the replay of a recording and decides which timestamp the replayed images get.
+ *
+ * In real time mode at a time scale of 1, the images are stamped with the time they are handed to the pipeline, as if they just arrived from the cameras.
+ * Otherwise the wall clock no longer matches the recording, so the images keep their recorded timestamps.
+ * Every further pass over the recording is shifted behind the previous one, so that the timestamps of a source are still increasing.
+ * With recorded timestamps, the latency since capture in the latency statistics is meaningless, the processing and queue wait times are not affected.
+ */
+class ReplayClock {
+	ReplayConfig const _config;
+
+	std::chrono::time_point<std::chrono::system_clock> _images_time;
+	std::chrono::time_point<std::chrono::system_clock> _current_time;
+
+	std::uint64_t _offset = 0;
+	std::uint64_t _last_timestamp = 0;
+
+	[[nodiscard]] std::chrono::system_clock::duration scaled(std::chrono::system_clock::duration duration) const;
+
+   public:
+	explicit ReplayClock(ReplayConfig const& config);
+
+	/**
+	 * @brief Starts a new pass over the recording.
+	 *
+	 * @param arrived The arrival timestamp of the first image of the pass.
+	 * @param recorded The recording timestamp of the first image of the pass.
+	 */
+	void restart(std::uint64_t arrived, std::uint64_t recorded);
+
+	/**
+	 * @brief Waits until the image is due. Gaps of more than 5 s in the recording are shortened to 1 s. Returns immediately in as fast as possible mode.
+	 *
+	 * @param arrived The arrival timestamp of the image when it was recorded.
+	 */
+	void wait_until_due(std::uint64_t arrived);
+
+	/**
+	 * @brief Returns the timestamp of the replayed image.
+	 *
+	 * @param recorded The recording timestamp of the image.
+	 */
+	std::uint64_t timestamp(std::uint64_t recorded);
+
+	[[nodiscard]] ReplayConfig const& config() const { return _config; }
+};
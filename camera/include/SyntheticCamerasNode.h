@@ -0,0 +1,70 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "CompactObject.h"
+#include "Detection2D.h"
+#include "ImageData.h"
+#include "ImageDataRaw.h"
+#include "Pusher.h"
+#include "Shared.h"
+#include "SyntheticScene.h"
+
+/**
+ * @class SyntheticCamerasNode
+ * @brief Simulates hardware-triggered cameras that look at a SyntheticScene, so that the pipeline can be tested and benchmarked without a dataset.
+ *
+ * All cameras of the scene are triggered at the same time with the given frame rate, the frames of one trigger are pushed one after another.
+ * Depending on the output, the node pushes
+ * - ImageData: the rendered BGR image,
+ * - ImageDataRaw: the rendered image as BayerRG8 mosaic like the basler cameras deliver it, i.e. decoded with COLOR_BayerBG2BGR,
+ * - Detections2D: the ground truth boxes in the calibrated image size, e.g. to feed the tracker without inference.
+ *
+ * @tparam Output ImageData, ImageDataRaw or Detections2D.
+ */
+template <typename Output>
+class SyntheticCamerasNode : public Pusher<Output> {
+	std::shared_ptr<SyntheticScene const> _scene;
+	std::vector<std::string> _cameras;
+	int _height;
+	int _width;
+	std::chrono::nanoseconds _period;
+
+	std::chrono::system_clock::time_point _trigger;
+	std::size_t _next = 0;
+	cv::Mat _image;  // render target of the raw images
+
+	Output push() final;
+
+   public:
+	/**
+	 * @param scene The scene, it can be shared with other synthetic nodes to get consistent ground truth.
+	 * @param fps The frame rate of every camera.
+	 * @param height The height of the rendered images, 0 keeps the calibrated height.
+	 * @param width The width of the rendered images, 0 keeps the calibrated width.
+	 */
+	SyntheticCamerasNode(std::shared_ptr<SyntheticScene const> scene, double fps, int height = 0, int width = 0);
+};
+
+/**
+ * @class SyntheticObjectsNode
+ * @brief Pushes the ground truth world positions of a SyntheticScene with the given rate, e.g. to benchmark the streaming with many objects.
+ */
+class SyntheticObjectsNode : public Pusher<Shared<CompactObjects>> {
+	std::shared_ptr<SyntheticScene const> _scene;
+	std::chrono::nanoseconds _period;
+	std::chrono::system_clock::time_point _next;
+
+	Shared<CompactObjects> push() final;
+
+   public:
+	/**
+	 * @param scene The scene, it can be shared with other synthetic nodes to get consistent ground truth.
+	 * @param rate The number of pushes per second.
+	 */
+	SyntheticObjectsNode(std::shared_ptr<SyntheticScene const> scene, double rate);
+};
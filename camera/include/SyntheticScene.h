@@ -0,0 +1,98 @@
+#pragma once
+
+#include <Eigen/Eigen>
+#include <array>
+#include <cstdint>
+#include <map>
+#include <opencv2/opencv.hpp>
+#include <string>
+#include <vector>
+
+#include "CompactObject.h"
+#include "Detection2D.h"
+
+/**
+ * @brief A camera of the synthetic scene.
+ */
+struct SyntheticCameraConfig {
+	Eigen::Matrix<double, 3, 4> projection_matrix;  // from the ground plane coordinate system into the image, e.g. config::projection_matrix_s110_base_north_into_s110_n_cam_8
+	int height;                                     // height of the calibrated image
+	int width;                                      // width of the calibrated image
+};
+
+/**
+ * @brief Describes the content of the synthetic scene.
+ */
+struct SyntheticSceneConfig {
+	std::size_t objects = 10;  // number of moving objects
+	std::uint32_t seed = 0;    // the scene is fully determined by the seed
+	Eigen::Matrix<double, 4, 4> affine_transformation_base_to_utm = Eigen::Matrix<double, 4, 4>::Identity();  // applied to the world positions of the ground truth, same as for TrackToTrackFusionNode
+};
+
+/**
+ * @class SyntheticScene
+ * @brief Objects that move on the ground plane in front of calibrated cameras, with the ground truth of every camera and of the world positions.
+ *
+ * Every object drives back and forth between two ground points that lie in the view of one camera, so the scene is a pure function of the timestamp.
+ * The ground truth boxes are the projections of the object cuboids, occlusions between objects are not taken into account.
+ * Objects are rendered as filled boxes with the painter's algorithm, far objects first.
+ * The scene is immutable after construction, so any number of nodes in any number of threads can share it.
+ */
+class SyntheticScene {
+	struct MovingObject {
+		unsigned int id;
+		std::uint8_t object_class;            // COCO class, as output by YoloNode
+		std::array<double, 3> size;           // height, width, depth in m
+		Eigen::Vector3d from;                 // ground point the object starts at
+		Eigen::Vector3d to;                   // ground point the object turns around at
+		std::uint64_t period;                 // duration of one round trip in ns
+		std::uint64_t offset;                 // phase of the round trip in ns
+		std::array<std::uint8_t, 3> color;    // bgr
+	};
+
+	struct ProjectedObject {
+		double depth;
+		Detection2D detection;
+		std::array<std::uint8_t, 3> color;
+	};
+
+	std::map<std::string, SyntheticCameraConfig> _cameras;
+	Eigen::Matrix<double, 4, 4> _affine_transformation_base_to_utm;
+	std::vector<MovingObject> _objects;
+
+	/**
+	 * @brief Returns the position and the velocity of the object on the ground plane.
+	 */
+	[[nodiscard]] std::pair<Eigen::Vector3d, Eigen::Vector3d> state(MovingObject const& object, std::uint64_t timestamp) const;
+
+	/**
+	 * @brief Projects all objects that are in front of the camera and intersect its image, sorted from far to near.
+	 */
+	[[nodiscard]] std::vector<ProjectedObject> project(std::string const& camera, std::uint64_t timestamp) const;
+
+   public:
+	/**
+	 * @param cameras The cameras with their calibration.
+	 * @param config The number of objects and the seed.
+	 */
+	SyntheticScene(std::map<std::string, SyntheticCameraConfig> cameras, SyntheticSceneConfig const& config);
+
+	/**
+	 * @brief Returns the ground truth bounding boxes of the camera in the calibrated image size.
+	 */
+	[[nodiscard]] Detections2D detections(std::string const& camera, std::uint64_t timestamp) const;
+
+	/**
+	 * @brief Returns the ground truth world positions and velocities of all objects.
+	 */
+	[[nodiscard]] CompactObjects objects(std::uint64_t timestamp) const;
+
+	/**
+	 * @brief Renders the view of the camera into the image, the image is scaled to its size.
+	 *
+	 * @param image A CV_8UC3 image, it is allocated with the calibrated size if it is empty.
+	 */
+	void render(std::string const& camera, std::uint64_t timestamp, cv::Mat& image) const;
+
+	[[nodiscard]] std::map<std::string, SyntheticCameraConfig> const& cameras() const { return _cameras; }
+};
@@ -67,7 +67,7 @@ ImageDataRaw BaslerCameraNode<v2>::push() {
 			ImageDataRaw data;
 			data.timestamp = ptrGrabResult->GetTimeStamp();
 			data.source = _camera_name;
-			data.image_raw = std::vector<std::uint8_t>(static_cast<const std::uint8_t*>(ptrGrabResult->GetBuffer()), static_cast<const std::uint8_t*>(ptrGrabResult->GetBuffer()) + ptrGrabResult->GetBufferSize());
+			data.image_raw = make_grab_buffer(ptrGrabResult, ptrGrabResult->GetBuffer(), ptrGrabResult->GetBufferSize());
 
 			std::chrono::nanoseconds image_creation_timestamp = std::chrono::nanoseconds(ptrGrabResult->GetTimeStamp());
 			std::chrono::nanoseconds current_server_timestamp = std::chrono::time_point_cast<std::chrono::nanoseconds>(std::chrono::system_clock::now()).time_since_epoch();
@@ -3,16 +3,19 @@
 #include <pylon/GrabResultPtr.h>
 #include <pylon/PylonIncludes.h>
 
-#include <boost/circular_buffer.hpp>
 
 template <bool v2>
-BaslerCamerasNode<v2>::BaslerCamerasNode(std::map<std::string, MacAddressConfig>&& camera_name_mac_address) {
+BaslerCamerasNode<v2>::BaslerCamerasNode(std::map<std::string, MacAddressConfig>&& camera_name_mac_address, std::optional<ThreadPlacementConfig> grab_thread_placement, std::size_t const downstream_queue_depth,
+    GrabMode const grab_mode)
+    : _grab_thread_placement(std::move(grab_thread_placement)), _grab_mode(grab_mode) {
 	auto index = 0;
 	for (auto const& [cam_name, mac_address] : camera_name_mac_address) {
 		_camera_name_mac_address_index_map.emplace(cam_name, mac_address.address, index++);
 	}
 	_cameras.Initialize(index);
 
+	for (auto i = 0; i < index; ++i) _statistics.push_back(std::make_unique<GrabStatistics>());
+
 	Pylon::CDeviceInfo info;
 	info.SetDeviceClass(Pylon::BaslerGigEDeviceClass);
 
@@ -40,6 +43,9 @@ BaslerCamerasNode<v2>::BaslerCamerasNode(std::map<std::string, MacAddressConfig>
 
 			_cameras[config->index].AcquisitionFrameRateEnable.SetValue(true);
 			_cameras[config->index].AcquisitionFrameRateAbs.SetValue(config->fps);
+
+			// the images reference the grab buffers until the pipeline releases them, so there must be enough buffers left for grabbing
+			_cameras[config->index].MaxNumBuffer.SetValue(grab_buffer_count(_grab_mode == GrabMode::per_camera ? downstream_queue_depth + merge_queue_depth : downstream_queue_depth));
 		}
 
 		common::print_loc("Starting grabbing...");
@@ -50,42 +56,104 @@ BaslerCamerasNode<v2>::BaslerCamerasNode(std::map<std::string, MacAddressConfig>
 	} catch (Pylon::GenericException const& e) {
 		common::println_critical_loc(e.GetDescription());
 	}
+
+	if (_grab_mode == GrabMode::per_camera) {
+		// holds the images of every camera while the merge waits for the other cameras, the oldest images are evicted to keep the latest ones flowing
+		_merge.emplace(index, merge_queue_depth, merge_window);
+
+		for (auto const& config : _camera_name_mac_address_index_map) {
+			_grab_threads.emplace_back([this, &config](std::stop_token const& stop) { grab_loop(stop, config); });
+		}
+	}
 }
 
 template <bool v2>
-ImageDataRaw BaslerCamerasNode<v2>::push() {
-	auto& index_indexing = _camera_name_mac_address_index_map.template get<typename CameraNameMacAddressIndexConfig::IndexTag>();
-	do {
+void BaslerCamerasNode<v2>::print_statistics() const {
+	for (auto const& config : _camera_name_mac_address_index_map) {
+		auto const& statistics = *_statistics[config.index];
+
+		double const mean_interval = statistics.frame_interval.mean();
+		common::println(config.camera_name, ": ", statistics.grabbed.load(std::memory_order_relaxed), " grabbed, ", statistics.failed.load(std::memory_order_relaxed), " failed, ",
+		    statistics.dropped.load(std::memory_order_relaxed), " dropped, fps ", mean_interval > 0. ? 1e9 / mean_interval : 0., ", grab latency p50 ", statistics.grab_latency.percentile(0.5) / 1e6, " ms, p99 ",
+		    statistics.grab_latency.percentile(0.99) / 1e6, " ms");
+	}
+}
+
+template <bool v2>
+std::optional<ImageDataRaw> BaslerCamerasNode<v2>::to_image(Pylon::CGrabResultPtr const& grab_result, CameraNameMacAddressIndexConfig const& config) {
+	auto& statistics = *_statistics[config.index];
+
+	if (!grab_result->GrabSucceeded()) {
+		statistics.failed.fetch_add(1, std::memory_order_relaxed);
+		common::println_error_loc(config.camera_name, ": ", grab_result->GetErrorDescription());
+
+		return std::nullopt;
+	}
+
+	ImageDataRaw data;
+	data.timestamp = grab_result->GetTimeStamp();
+	data.source = config.camera_name;
+	data.image_raw = make_grab_buffer(grab_result, grab_result->GetBuffer(), grab_result->GetBufferSize());
+
+	// the camera timestamps are ptp synchronized to the server clock
+	auto const current_server_timestamp = static_cast<std::uint64_t>(std::chrono::time_point_cast<std::chrono::nanoseconds>(std::chrono::system_clock::now()).time_since_epoch().count());
+	if (current_server_timestamp > data.timestamp) statistics.grab_latency.record(current_server_timestamp - data.timestamp);
+
+	// only the grab thread of the camera writes, so a plain exchange is enough
+	if (auto const last_timestamp = statistics.last_timestamp.exchange(data.timestamp, std::memory_order_relaxed); last_timestamp && data.timestamp > last_timestamp) {
+		statistics.frame_interval.record(data.timestamp - last_timestamp);
+	}
+	statistics.grabbed.fetch_add(1, std::memory_order_relaxed);
+
+	return data;
+}
+
+template <bool v2>
+void BaslerCamerasNode<v2>::grab_loop(std::stop_token const& stop, CameraNameMacAddressIndexConfig const& config) {
+	if (_grab_thread_placement) place_this_thread("basler grab " + config.camera_name, *_grab_thread_placement);
+
+	auto& camera = _cameras[config.index];
+
+	while (!stop.stop_requested()) {
 		try {
+			// returns regularly, so that the thread notices when the node is destroyed
 			Pylon::CGrabResultPtr ptrGrabResult;
-			_cameras.RetrieveResult(5000, ptrGrabResult, Pylon::TimeoutHandling_ThrowException);
+			if (!camera.RetrieveResult(500, ptrGrabResult, Pylon::TimeoutHandling_Return)) continue;
 
-			auto const& config = index_indexing.find(ptrGrabResult->GetCameraContext());
+			auto data = to_image(ptrGrabResult, config);
+			if (!data) continue;
 
-			if (!ptrGrabResult->GrabSucceeded()) {
-				common::println_error_loc(config->camera_name, ": ", ptrGrabResult->GetErrorDescription());
-
-				continue;
-			}
+			if (!_merge->push(config.index, std::move(*data))) _statistics[config.index]->dropped.fetch_add(1, std::memory_order_relaxed);
+		} catch (Pylon::GenericException const& e) {
+			common::println_error_loc(config.camera_name, ": ", e.GetDescription());
+		}
+	}
+}
 
-			ImageDataRaw data;
-			data.timestamp = ptrGrabResult->GetTimeStamp();
-			data.source = config->camera_name;
-			data.image_raw = std::vector<std::uint8_t>(static_cast<const std::uint8_t*>(ptrGrabResult->GetBuffer()), static_cast<const std::uint8_t*>(ptrGrabResult->GetBuffer()) + ptrGrabResult->GetBufferSize());
+template <bool v2>
+ImageDataRaw BaslerCamerasNode<v2>::push() {
+	// in per camera mode, the grab threads are placed by themselves and the caller of push only merges
+	if (_grab_mode == GrabMode::per_camera) {
+		if (!_close_on_stop) _close_on_stop.emplace(stop_token, [this] { _merge->close(); });
 
-			std::chrono::nanoseconds image_creation_timestamp = std::chrono::nanoseconds(ptrGrabResult->GetTimeStamp());
-			std::chrono::nanoseconds current_server_timestamp = std::chrono::time_point_cast<std::chrono::nanoseconds>(std::chrono::system_clock::now()).time_since_epoch();
+		if (auto data = _merge->pop()) return std::move(*data);
+		return ImageDataRaw{};
+	}
 
-			// calculate fps by saving image capture times consecutive and take the average.
-			static std::vector<boost::circular_buffer<std::chrono::nanoseconds>> fps_buffers =
-			    std::vector<boost::circular_buffer<std::chrono::nanoseconds>>(_cameras.GetSize(), boost::circular_buffer<std::chrono::nanoseconds>(20, std::chrono::nanoseconds(0)));
-			auto fps = 20. / std::chrono::duration<double>(current_server_timestamp - fps_buffers[config->index].front()).count();
-			fps_buffers[config->index].push_back(current_server_timestamp);
+	// the grab thread is created by the caller of push, so it can only place itself
+	std::call_once(_grab_thread_placed, [this] {
+		if (_grab_thread_placement) place_this_thread("basler grab", *_grab_thread_placement);
+	});
 
-			common::println_debug_loc(config->camera_name, ": grab successful at ", image_creation_timestamp, " with grab duration ", current_server_timestamp - image_creation_timestamp, " and fps ", fps, ".");
+	auto& index_indexing = _camera_name_mac_address_index_map.template get<typename CameraNameMacAddressIndexConfig::IndexTag>();
+	do {
+		try {
+			Pylon::CGrabResultPtr ptrGrabResult;
+			_cameras.RetrieveResult(5000, ptrGrabResult, Pylon::TimeoutHandling_ThrowException);
 
-			return data;
+			auto const& config = index_indexing.find(ptrGrabResult->GetCameraContext());
 
+			if (auto data = to_image(ptrGrabResult, *config)) return std::move(*data);
 		} catch (Pylon::TimeoutException const& e) {
 			common::println_error_loc(e.GetDescription());
 		}
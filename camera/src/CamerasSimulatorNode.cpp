@@ -1,47 +1,81 @@
 #include "CamerasSimulatorNode.h"
 
+#include <algorithm>
 #include <opencv2/opencv.hpp>
 
+#include "LatencyTracer.h"
+
 using namespace std::chrono_literals;
 
+/**
+ * Keeps the configured number of images in flight. The images are decoded in parallel by the TBB worker threads in the order of the queue.
+ * When the queue is empty, it is refilled and the next image is marked as the start of a new pass.
+ */
+void CamerasSimulatorNode::prefetch() {
+	while (_prefetched.size() < std::max<std::size_t>(_clock.config().prefetch_depth, 1)) {
+		bool const first_of_pass = _queue.empty();
+		if (first_of_pass) _queue = decltype(_queue)(_files.begin(), _files.end());
+
+		auto file = _queue.top();
+		_queue.pop();
+
+		auto decode = std::make_shared<Decode>();
+		decode->task = std::packaged_task<cv::Mat()>([path = file.filepath, cache = _cache.get()] {
+			if (cache) {
+				if (auto image = cache->find(path)) return std::move(*image);
+			}
+
+			cv::Mat image = cv::imread(path);
+			if (cache) cache->insert(path, image);
+			return image;
+		});
+		auto image = decode->task.get_future();
+
+		if (_clock.config().prefetch_depth)
+			_decoders->run([decode] { (*decode)(); });
+		else
+			(*decode)();
+
+		_prefetched.emplace_back(std::move(file), first_of_pass, std::move(decode), std::move(image));
+	}
+}
+
 /**
  * Sets up a queue that sorts the images by the time they arrived when they were taken.
  * The queue then pops the image filename and its additional information one at a time, waiting for the same amount of time that elapsed between the arrival of the images.
- * After waiting, it reads the image into the return value.
+ * Depending on the replay config, the waiting time is scaled or skipped, see ReplayClock.
+ * The images are decoded ahead, so that only the pacing happens on the critical path.
  * When the queue is empty, the process is restarted.
  *
  * @return Image data in the form of ImageData i.e. in BGR form.
  */
 ImageData CamerasSimulatorNode::push() {
-	if (_queue.empty()) {
-		_queue = decltype(_queue)(_files.begin(), _files.end());
+	prefetch();
 
-		auto const [path, arrived, recorded, source] = _queue.top();
+	auto [file, first_of_pass, decode, image] = std::move(_prefetched.front());
+	_prefetched.pop_front();
 
-		std::this_thread::sleep_for(1s);
+	// if no worker started to decode this image yet, e.g. because TBB has no worker threads on a single core, this thread decodes it itself
+	// otherwise get() only waits for this image instead of the whole prefetch window
+	(*decode)();
 
-		_images_time = std::chrono::time_point<std::chrono::system_clock>(std::chrono::nanoseconds(arrived));
-		_current_time = std::chrono::system_clock::now();
-	}
-
-	auto const [path, arrived, recorded, source] = _queue.top();
-	_queue.pop();
+	// the decoding of the next image starts before this one is due
+	prefetch();
 
-	std::chrono::time_point<std::chrono::system_clock> next = std::chrono::time_point<std::chrono::system_clock>(std::chrono::nanoseconds(arrived));
+	auto const& [path, arrived, recorded, source] = file;
+	if (first_of_pass) _clock.restart(arrived, recorded);
 
 	ImageData data;
-	data.image = cv::imread(path);
+	data.image = image.get();
 	data.source = source;
 
-	if (next - _images_time > 5s) {
-		_images_time = std::chrono::time_point<std::chrono::system_clock>(std::chrono::nanoseconds(arrived));
-		_current_time = std::chrono::system_clock::now() + 1s;
-	}
+	_clock.wait_until_due(arrived);
 
-	std::this_thread::sleep_until(_current_time + (next - _images_time));
+	data.timestamp = _clock.timestamp(recorded);
 
-	data.timestamp = std::chrono::time_point_cast<std::chrono::nanoseconds>(std::chrono::system_clock::now()).time_since_epoch().count();
-	// data.timestamp = (std::chrono::time_point_cast<std::chrono::nanoseconds>(std::chrono::system_clock::now()) + std::chrono::nanoseconds(recorded) - std::chrono::nanoseconds(arrived)).time_since_epoch().count();
+	// the trace starts when the image is handed to the pipeline, i.e. after the image was read and the simulated arrival time was reached
+	static auto& stage = latency_stage("cams");
+	data.trace = TraceScope(stage).finish(data.timestamp);
 
 	return data;
 }
@@ -50,5 +84,23 @@ ImageData CamerasSimulatorNode::push() {
  * @brief Initializes a vector containing the image filenames and their additional information coming from a factory method.
  *
  * @param files The vector of image filenames and their additional information.
+ * @param replay Whether the recording is replayed in real time, scaled or as fast as possible, how many images are decoded ahead and how many are cached.
+ */
+CamerasSimulatorNode::CamerasSimulatorNode(std::vector<FilepathArrivedRecordedSourceConfig>&& files, ReplayConfig const& replay)
+    : _files(std::forward<decltype(files)>(files)), _clock(replay), _cache(replay.cache_budget ? std::make_unique<DecodedFrameCache>(replay.cache_budget) : nullptr) {}
+
+/**
+ * @brief Waits for the images that are still being decoded.
  */
-CamerasSimulatorNode::CamerasSimulatorNode(std::vector<FilepathArrivedRecordedSourceConfig>&& files) : _files(std::forward<decltype(files)>(files)) {}
+CamerasSimulatorNode::~CamerasSimulatorNode() {
+	if (_decoders) _decoders->wait();
+}
+
+void CamerasSimulatorNode::print_cache_statistics() const {
+	if (_cache) _cache->print_statistics();
+}
+
+std::optional<DecodedFrameCacheStatistics> CamerasSimulatorNode::cache_statistics() const {
+	if (!_cache) return std::nullopt;
+	return _cache->statistics();
+}
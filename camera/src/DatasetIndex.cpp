@@ -0,0 +1,227 @@
+#include "DatasetIndex.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <tbb/parallel_for.h>
+#include <unistd.h>
+
+#include <array>
+#include <charconv>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <optional>
+#include <string_view>
+#include <thread>
+
+#include "common_output.h"
+
+namespace {
+struct IndexedFile {
+	std::string name;
+	std::uint64_t arrived;
+	std::uint64_t recorded;
+};
+
+constexpr std::array<char, 8> manifest_magic = {'D', 'S', 'M', 'A', 'N', 'I', 'F', '\0'};
+constexpr std::uint32_t manifest_version = 1;
+
+struct ManifestHeader {
+	std::array<char, 8> magic;
+	std::uint32_t version;
+	std::uint32_t names;
+	std::int64_t folder_time;  // modification time of the folder when it was scanned
+	std::uint64_t files;
+	std::uint64_t string_table_size;
+};
+
+struct ManifestEntry {
+	std::uint64_t arrived;
+	std::uint64_t recorded;
+	std::uint64_t name_offset;
+	std::uint64_t name_size;
+};
+
+/**
+ * @brief Parses the digits at the beginning of the text.
+ * @return The number and the rest of the text, if the text starts with a digit and the number fits.
+ */
+std::optional<std::pair<std::uint64_t, std::string_view>> parse_number(std::string_view const text) {
+	std::uint64_t number;
+	auto const [end, error] = std::from_chars(text.data(), text.data() + text.size(), number);
+	if (error != std::errc{}) return std::nullopt;
+
+	return std::pair{number, text.substr(end - text.data())};
+}
+
+std::optional<IndexedFile> parse_file_name(std::string name, DatasetFileNames const names) {
+	std::string_view const view = name;
+
+	switch (names) {
+		case DatasetFileNames::arrived_recorded: {
+			auto const arrived = parse_number(view);
+			if (!arrived || !arrived->second.starts_with('_')) return std::nullopt;
+			auto const recorded = parse_number(arrived->second.substr(1));
+			if (!recorded || !recorded->second.empty()) return std::nullopt;
+
+			return IndexedFile{std::move(name), arrived->first, recorded->first};
+		}
+		case DatasetFileNames::arrived_milliseconds: {
+			auto const arrived = parse_number(view);
+			if (!arrived || !(arrived->second.empty() || arrived->second.starts_with('.'))) return std::nullopt;
+
+			std::uint64_t const nanoseconds = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::milliseconds(arrived->first)).count();
+			return IndexedFile{std::move(name), nanoseconds, nanoseconds};
+		}
+		case DatasetFileNames::tumtraf: {
+			// the timestamp is the concatenation of the seconds and the nanoseconds part
+			std::size_t const first = view.find('_');
+			std::size_t const second = view.find('_', first + 1);
+			if (first == std::string_view::npos || second == std::string_view::npos || !view.ends_with(".jpg")) return std::nullopt;
+
+			std::string digits = std::string(view.substr(0, first)) + std::string(view.substr(first + 1, second - first - 1));
+			auto const timestamp = parse_number(digits);
+			if (!timestamp || !timestamp->second.empty()) return std::nullopt;
+
+			return IndexedFile{std::move(name), timestamp->first, timestamp->first};
+		}
+	}
+
+	return std::nullopt;
+}
+
+std::vector<IndexedFile> scan_folder(std::filesystem::path const& folder, DatasetFileNames const names) {
+	std::vector<IndexedFile> ret;
+
+	std::size_t skipped = 0;
+	for (auto const& file : std::filesystem::directory_iterator(folder)) {
+		if (!file.is_regular_file()) continue;
+
+		if (auto indexed = parse_file_name(file.path().filename().string(), names))
+			ret.push_back(std::move(*indexed));
+		else
+			++skipped;
+	}
+
+	if (skipped) common::println_warn_loc("Skipped ", skipped, " files in ", folder, " that do not match the naming scheme!");
+
+	return ret;
+}
+
+std::filesystem::path manifest_path(std::filesystem::path const& folder, DatasetFileNames const names) {
+	auto const canonical = std::filesystem::weakly_canonical(folder);
+	return canonical.parent_path() / (canonical.filename().string() + '.' + std::to_string(static_cast<int>(names)) + ".manifest");
+}
+
+std::int64_t folder_time(std::filesystem::path const& folder) { return std::filesystem::last_write_time(folder).time_since_epoch().count(); }
+
+std::optional<std::vector<IndexedFile>> read_manifest(std::filesystem::path const& folder, DatasetFileNames const names) {
+	auto const path = manifest_path(folder, names);
+
+	int const fd = ::open(path.c_str(), O_RDONLY);
+	if (fd < 0) return std::nullopt;
+
+	struct stat status{};
+	::fstat(fd, &status);
+	auto const size = static_cast<std::size_t>(status.st_size);
+
+	void* const data = size >= sizeof(ManifestHeader) ? ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0) : MAP_FAILED;
+	::close(fd);
+	if (data == MAP_FAILED) return std::nullopt;
+
+	std::optional<std::vector<IndexedFile>> ret;
+
+	ManifestHeader header;
+	std::memcpy(&header, data, sizeof(header));
+	if (header.magic == manifest_magic && header.version == manifest_version && header.names == static_cast<std::uint32_t>(names) && header.folder_time == folder_time(folder) &&
+	    size == sizeof(ManifestHeader) + header.files * sizeof(ManifestEntry) + header.string_table_size) {
+		auto const* const entries = static_cast<char const*>(data) + sizeof(ManifestHeader);
+		auto const* const strings = entries + header.files * sizeof(ManifestEntry);
+
+		ret.emplace();
+		ret->reserve(header.files);
+		for (std::uint64_t i = 0; i < header.files; ++i) {
+			ManifestEntry entry;
+			std::memcpy(&entry, entries + i * sizeof(ManifestEntry), sizeof(entry));
+			if (entry.name_offset + entry.name_size > header.string_table_size) {
+				ret.reset();
+				break;
+			}
+
+			ret->emplace_back(std::string(strings + entry.name_offset, entry.name_size), entry.arrived, entry.recorded);
+		}
+	}
+
+	::munmap(data, size);
+	return ret;
+}
+
+void write_manifest(std::filesystem::path const& folder, DatasetFileNames const names, std::int64_t const scanned_folder_time, std::vector<IndexedFile> const& files) {
+	auto const path = manifest_path(folder, names);
+	// a source may list the same folder twice, so the temporary file is unique per thread
+	auto const temporary = std::filesystem::path(path).concat(".tmp." + std::to_string(std::hash<std::thread::id>{}(std::this_thread::get_id())));
+
+	std::vector<ManifestEntry> entries;
+	entries.reserve(files.size());
+	std::string strings;
+	for (auto const& [name, arrived, recorded] : files) {
+		entries.emplace_back(arrived, recorded, strings.size(), name.size());
+		strings += name;
+	}
+
+	ManifestHeader const header{manifest_magic, manifest_version, static_cast<std::uint32_t>(names), scanned_folder_time, files.size(), strings.size()};
+
+	{
+		std::ofstream out(temporary, std::ios::binary | std::ios::trunc);
+		out.write(reinterpret_cast<char const*>(&header), sizeof(header));
+		out.write(reinterpret_cast<char const*>(entries.data()), static_cast<std::streamsize>(entries.size() * sizeof(ManifestEntry)));
+		out.write(strings.data(), static_cast<std::streamsize>(strings.size()));
+
+		if (!out) {
+			common::println_warn_loc("Could not write the manifest ", path, ", the folder will be scanned again next time!");
+			std::error_code error;
+			std::filesystem::remove(temporary, error);
+			return;
+		}
+	}
+
+	// the rename replaces the manifest atomically, so that a concurrent reader never sees a partial manifest
+	std::error_code error;
+	std::filesystem::rename(temporary, path, error);
+	if (error) common::println_warn_loc("Could not write the manifest ", path, ": ", error.message(), '!');
+}
+}  // namespace
+
+std::vector<DatasetFile> index_dataset(std::vector<std::pair<std::string, std::filesystem::path>> const& folders, DatasetFileNames const names, bool const use_manifests) {
+	std::vector<std::vector<IndexedFile>> indexed(folders.size());
+
+	tbb::parallel_for(std::size_t{0}, folders.size(), [&](std::size_t const i) {
+		auto const& folder = folders[i].second;
+		if (!std::filesystem::is_directory(folder)) {
+			common::println_warn_loc("The folder ", folder, " does not exist!");
+			return;
+		}
+
+		if (use_manifests) {
+			if (auto manifest = read_manifest(folder, names)) {
+				indexed[i] = std::move(*manifest);
+				return;
+			}
+		}
+
+		// the time is taken before the scan, so that files added during the scan invalidate the manifest
+		std::int64_t const scanned_folder_time = folder_time(folder);
+		indexed[i] = scan_folder(folder, names);
+
+		if (use_manifests) write_manifest(folder, names, scanned_folder_time, indexed[i]);
+	});
+
+	std::vector<DatasetFile> ret;
+	for (std::size_t i = 0; i < folders.size(); ++i) {
+		auto const& [source, folder] = folders[i];
+		for (auto& [name, arrived, recorded] : indexed[i]) ret.emplace_back(folder / name, arrived, recorded, source);
+	}
+
+	return ret;
+}
@@ -0,0 +1,73 @@
+#include "DecodedFrameCache.h"
+
+#include "common_output.h"
+
+DecodedFrameCache::DecodedFrameCache(std::size_t const budget) : _budget(budget) {}
+
+std::optional<cv::Mat> DecodedFrameCache::find(std::filesystem::path const& path) const {
+	cv::Mat image;
+	bool compressed;
+	{
+		std::scoped_lock lock(_mutex);
+		auto const entry = _entries.find(path.string());
+		if (entry == _entries.end()) {
+			++_misses;
+			return std::nullopt;
+		}
+
+		// the cached images are never modified, so the pixels can be read without holding the lock
+		image = entry->second.image;
+		compressed = entry->second.compressed;
+	}
+
+	cv::Mat ret;
+	if (compressed) {
+		cv::cvtColor(image, ret, cv::COLOR_YUV2BGR_I420);
+		++_compressed_hits;
+	} else {
+		ret = image.clone();
+		++_hits;
+	}
+
+	return ret;
+}
+
+void DecodedFrameCache::insert(std::filesystem::path const& path, cv::Mat const& image) {
+	if (image.empty()) return;
+
+	std::size_t const bytes = image.total() * image.elemSize();
+	bool const compressible = image.type() == CV_8UC3 && image.rows % 2 == 0 && image.cols % 2 == 0;
+
+	std::scoped_lock lock(_mutex);
+	if (_entries.contains(path.string())) return;
+
+	if (_used + bytes <= _budget) {
+		_entries.emplace(path.string(), Entry{image.clone(), false});
+		_used += bytes;
+	} else if (compressible && _used + bytes / 2 <= _budget) {
+		cv::Mat compressed;
+		cv::cvtColor(image, compressed, cv::COLOR_BGR2YUV_I420);
+		_used += compressed.total() * compressed.elemSize();
+		_entries.emplace(path.string(), Entry{std::move(compressed), true});
+	} else {
+		++_rejected;
+	}
+}
+
+DecodedFrameCacheStatistics DecodedFrameCache::statistics() const {
+	DecodedFrameCacheStatistics ret{.hits = _hits.load(), .compressed_hits = _compressed_hits.load(), .misses = _misses.load(), .rejected = _rejected.load(), .budget = _budget};
+
+	std::scoped_lock lock(_mutex);
+	ret.frames = _entries.size();
+	ret.used = _used;
+	return ret;
+}
+
+void DecodedFrameCache::print_statistics() const {
+	auto const statistics = this->statistics();
+	std::uint64_t const hits = statistics.hits + statistics.compressed_hits;
+	std::uint64_t const total = hits + statistics.misses;
+
+	common::println("decoded frame cache: ", statistics.frames, " frames in ", statistics.used / (1 << 20), " of ", statistics.budget / (1 << 20), " MiB, hit rate ", total ? 100. * static_cast<double>(hits) / static_cast<double>(total) : 0., "% (",
+	    statistics.compressed_hits, " of ", hits, " hits compressed), ", statistics.rejected, " frames did not fit");
+}
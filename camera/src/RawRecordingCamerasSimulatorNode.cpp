@@ -0,0 +1,34 @@
+#include "RawRecordingCamerasSimulatorNode.h"
+
+#include "common_output.h"
+
+RawRecordingCamerasSimulatorNode::RawRecordingCamerasSimulatorNode(std::filesystem::path const& folder, ReplayConfig const& replay) : _recording(folder), _clock(replay) {
+	if (!_recording.size()) common::println_critical_loc("No frames found in the raw recording ", folder, '!');
+}
+
+/**
+ * Pushes the frames in the order of their arrival, waiting for the same amount of time that elapsed between their arrival.
+ * When all frames are pushed, the recording is replayed again.
+ *
+ * @return Image data in the form of ImageDataRaw i.e. in BayerRG8 form.
+ */
+ImageDataRaw RawRecordingCamerasSimulatorNode::push() {
+	if (_next == _recording.size()) _next = 0;
+
+	auto const& entry = _recording.entry(_next);
+	if (_next == 0) _clock.restart(entry.arrived, entry.recorded);
+
+	// the page cache fills with the next frame while this one waits for its turn
+	_recording.prefetch(_next + 1);
+
+	ImageDataRaw data;
+	data.image_raw = _recording.frame(_next);
+	data.source = _recording.source(entry);
+
+	_clock.wait_until_due(entry.arrived);
+
+	data.timestamp = _clock.timestamp(entry.recorded);
+
+	++_next;
+	return data;
+}
@@ -0,0 +1,51 @@
+#include "ReplayClock.h"
+
+#include <thread>
+
+#include "common_output.h"
+
+using namespace std::chrono_literals;
+
+/**
+ * @param config The replay mode and time scale.
+ */
+ReplayClock::ReplayClock(ReplayConfig const& config) : _config(config) {
+	if (!(_config.time_scale > 0.)) common::println_critical_loc("The time scale of the replay must be positive, got ", _config.time_scale, '!');
+}
+
+std::chrono::system_clock::duration ReplayClock::scaled(std::chrono::system_clock::duration const duration) const {
+	return std::chrono::duration_cast<std::chrono::system_clock::duration>(std::chrono::duration<double, std::chrono::system_clock::period>(duration) / _config.time_scale);
+}
+
+void ReplayClock::restart(std::uint64_t const arrived, std::uint64_t const recorded) {
+	if (_last_timestamp) _offset = _last_timestamp + std::chrono::nanoseconds(1s).count() - recorded;
+
+	if (_config.mode == ReplayMode::as_fast_as_possible) return;
+
+	std::this_thread::sleep_for(scaled(1s));
+
+	_images_time = std::chrono::time_point<std::chrono::system_clock>(std::chrono::nanoseconds(arrived));
+	_current_time = std::chrono::system_clock::now();
+}
+
+void ReplayClock::wait_until_due(std::uint64_t const arrived) {
+	if (_config.mode == ReplayMode::as_fast_as_possible) return;
+
+	std::chrono::time_point<std::chrono::system_clock> const next = std::chrono::time_point<std::chrono::system_clock>(std::chrono::nanoseconds(arrived));
+
+	if (next - _images_time > 5s) {
+		_images_time = next;
+		_current_time = std::chrono::system_clock::now() + scaled(1s);
+	}
+
+	std::this_thread::sleep_until(_current_time + scaled(next - _images_time));
+}
+
+std::uint64_t ReplayClock::timestamp(std::uint64_t const recorded) {
+	if (_config.mode == ReplayMode::real_time && _config.time_scale == 1.)
+		_last_timestamp = std::chrono::time_point_cast<std::chrono::nanoseconds>(std::chrono::system_clock::now()).time_since_epoch().count();
+	else
+		_last_timestamp = recorded + _offset;
+
+	return _last_timestamp;
+}
@@ -0,0 +1,77 @@
+#include "SyntheticCamerasNode.h"
+
+#include <thread>
+
+#include "common_output.h"
+
+static std::chrono::nanoseconds to_period(double const rate) {
+	if (rate <= 0.) common::println_critical_loc("The rate of a synthetic node must be positive!");
+	return std::chrono::nanoseconds(static_cast<std::int64_t>(1e9 / rate));
+}
+
+static std::uint64_t to_timestamp(std::chrono::system_clock::time_point const time) { return std::chrono::duration_cast<std::chrono::nanoseconds>(time.time_since_epoch()).count(); }
+
+template <typename Output>
+SyntheticCamerasNode<Output>::SyntheticCamerasNode(std::shared_ptr<SyntheticScene const> scene, double const fps, int const height, int const width)
+    : _scene(std::move(scene)), _height(height), _width(width), _period(to_period(fps)), _trigger(std::chrono::system_clock::now()) {
+	for (auto const& [name, camera] : _scene->cameras()) _cameras.push_back(name);
+}
+
+/**
+ * Waits for the next trigger before the first camera of a trigger is pushed, the other cameras of the trigger follow immediately with the same timestamp.
+ */
+template <typename Output>
+Output SyntheticCamerasNode<Output>::push() {
+	if (_next == _cameras.size()) {
+		_next = 0;
+		_trigger += _period;
+	}
+	if (_next == 0) std::this_thread::sleep_until(_trigger);
+
+	auto const& camera = _cameras[_next++];
+	auto const& config = _scene->cameras().at(camera);
+	std::uint64_t const timestamp = to_timestamp(_trigger);
+
+	if constexpr (std::is_same_v<Output, Detections2D>) {
+		return _scene->detections(camera, timestamp);
+	} else {
+		int const height = _height ? _height : config.height;
+		int const width = _width ? _width : config.width;
+
+		if constexpr (std::is_same_v<Output, ImageData>) {
+			ImageData data{cv::Mat(height, width, CV_8UC3), timestamp, camera, {}};
+			_scene->render(camera, timestamp, data.image);
+			return data;
+		} else {
+			_image.create(height, width, CV_8UC3);
+			_scene->render(camera, timestamp, _image);
+
+			// RGGB mosaic: red on even rows and columns, blue on odd rows and columns, green in between
+			std::vector<std::uint8_t> raw(static_cast<std::size_t>(height) * width);
+			for (int y = 0; y < height; ++y) {
+				auto const* row = _image.ptr<std::uint8_t>(y);
+				auto* raw_row = raw.data() + static_cast<std::size_t>(y) * width;
+				for (int x = 0; x < width; ++x) {
+					int const channel = y % 2 == 0 ? (x % 2 == 0 ? 2 : 1) : (x % 2 == 0 ? 1 : 0);
+					raw_row[x] = row[x * 3 + channel];
+				}
+			}
+
+			return ImageDataRaw{std::move(raw), timestamp, camera};
+		}
+	}
+}
+
+template class SyntheticCamerasNode<ImageData>;
+template class SyntheticCamerasNode<ImageDataRaw>;
+template class SyntheticCamerasNode<Detections2D>;
+
+SyntheticObjectsNode::SyntheticObjectsNode(std::shared_ptr<SyntheticScene const> scene, double const rate) : _scene(std::move(scene)), _period(to_period(rate)), _next(std::chrono::system_clock::now()) {}
+
+Shared<CompactObjects> SyntheticObjectsNode::push() {
+	std::this_thread::sleep_until(_next);
+	std::uint64_t const timestamp = to_timestamp(_next);
+	_next += _period;
+
+	return make_shared_message(_scene->objects(timestamp));
+}
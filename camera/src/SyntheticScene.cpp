@@ -0,0 +1,174 @@
+#include "SyntheticScene.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <optional>
+#include <random>
+
+#include "common_output.h"
+
+namespace {
+	struct ObjectClass {
+		std::uint8_t object_class;
+		double probability;
+		std::array<double, 3> size;  // height, width, depth in m
+		double min_speed;            // in m/s
+		double max_speed;
+		std::array<std::uint8_t, 3> color;
+	};
+
+	// COCO classes: person, bicycle, car, truck
+	constexpr std::array object_classes = {
+	    ObjectClass{0, 0.1, {1.7, 0.6, 0.6}, 1., 2., {60, 60, 220}},
+	    ObjectClass{1, 0.1, {1.7, 0.7, 1.8}, 3., 7., {60, 200, 220}},
+	    ObjectClass{2, 0.7, {1.5, 1.8, 4.5}, 6., 14., {200, 120, 40}},
+	    ObjectClass{7, 0.1, {3.2, 2.5, 10.}, 5., 11., {40, 160, 60}},
+	};
+
+	constexpr double minimum_path_length = 10.;  // in m, so that every object visibly moves between frames
+
+	/**
+	 * @brief Intersects the viewing ray of the pixel with the ground plane z = 0.
+	 */
+	std::optional<Eigen::Vector3d> pixel_to_ground(Eigen::Matrix<double, 3, 4> const& projection_matrix, double const u, double const v) {
+		Eigen::Matrix<double, 3, 3> const KR_inv = projection_matrix.leftCols<3>().inverse();
+		Eigen::Vector3d const camera = -KR_inv * projection_matrix.col(3);
+		Eigen::Vector3d const ray = KR_inv * Eigen::Vector3d(u, v, 1.);
+
+		if (std::abs(ray.z()) < 1e-9) return std::nullopt;
+		double const s = -camera.z() / ray.z();
+		if (s <= 0.) return std::nullopt;
+
+		Eigen::Vector3d ground = camera + s * ray;
+		if ((ground - camera).norm() > 200.) return std::nullopt;
+		return ground;
+	}
+}  // namespace
+
+SyntheticScene::SyntheticScene(std::map<std::string, SyntheticCameraConfig> cameras, SyntheticSceneConfig const& config)
+    : _cameras(std::move(cameras)), _affine_transformation_base_to_utm(config.affine_transformation_base_to_utm) {
+	if (_cameras.empty()) common::println_critical_loc("The synthetic scene needs at least one camera!");
+
+	std::mt19937 generator(config.seed);
+	std::uniform_real_distribution<double> uniform(0., 1.);
+
+	std::vector<SyntheticCameraConfig const*> cameras_in_order;
+	for (auto const& [name, camera] : _cameras) cameras_in_order.push_back(&camera);
+
+	_objects.reserve(config.objects);
+	for (std::size_t i = 0; i < config.objects; ++i) {
+		auto const& camera = *cameras_in_order[i % cameras_in_order.size()];
+
+		// the paths start and end in the lower part of the image, which shows the ground in front of the camera
+		auto const sample = [&]() -> Eigen::Vector3d {
+			for (int attempt = 0; attempt < 100; ++attempt) {
+				if (auto ground = pixel_to_ground(camera.projection_matrix, camera.width * (0.05 + 0.9 * uniform(generator)), camera.height * (0.45 + 0.5 * uniform(generator)))) return *ground;
+			}
+			common::println_critical_loc("The camera does not see the ground plane!");
+		};
+		Eigen::Vector3d const from = sample();
+		Eigen::Vector3d to = sample();
+		for (int attempt = 0; attempt < 100 && (to - from).norm() < minimum_path_length; ++attempt) to = sample();
+
+		double probability = uniform(generator);
+		auto const object_class = std::ranges::find_if(object_classes, [&probability](ObjectClass const& c) { return (probability -= c.probability) < 0.; });
+		auto const& type = object_class != object_classes.end() ? *object_class : object_classes[2];
+
+		double const speed = type.min_speed + (type.max_speed - type.min_speed) * uniform(generator);
+		auto const period = static_cast<std::uint64_t>(std::max(2. * (to - from).norm() / speed, 1.) * 1e9);
+
+		// shades of the class color, so that neighbouring objects of the same class can be told apart
+		double const shade = 0.6 + 0.4 * uniform(generator);
+		std::array<std::uint8_t, 3> const color = {static_cast<std::uint8_t>(type.color[0] * shade), static_cast<std::uint8_t>(type.color[1] * shade), static_cast<std::uint8_t>(type.color[2] * shade)};
+
+		_objects.emplace_back(static_cast<unsigned int>(i), type.object_class, type.size, from, to, period, static_cast<std::uint64_t>(uniform(generator) * static_cast<double>(period)), color);
+	}
+}
+
+std::pair<Eigen::Vector3d, Eigen::Vector3d> SyntheticScene::state(MovingObject const& object, std::uint64_t const timestamp) const {
+	double const half_period = static_cast<double>(object.period) / 2.;
+	double const phase = static_cast<double>((timestamp + object.offset) % object.period) / half_period;
+	Eigen::Vector3d const velocity = (object.to - object.from) / (half_period * 1e-9);
+
+	if (phase <= 1.) return {object.from + (object.to - object.from) * phase, velocity};
+	return {object.to + (object.from - object.to) * (phase - 1.), -velocity};
+}
+
+std::vector<SyntheticScene::ProjectedObject> SyntheticScene::project(std::string const& camera, std::uint64_t const timestamp) const {
+	auto const& config = _cameras.at(camera);
+
+	std::vector<ProjectedObject> ret;
+	for (auto const& object : _objects) {
+		auto const [position, velocity] = state(object, timestamp);
+		double const yaw = std::atan2(velocity.y(), velocity.x());
+		Eigen::Vector3d const forward(std::cos(yaw), std::sin(yaw), 0.);
+		Eigen::Vector3d const left(-std::sin(yaw), std::cos(yaw), 0.);
+
+		double depth = 0.;
+		bool in_front = true;
+		BoundingBoxXYXY bbox{std::numeric_limits<double>::max(), std::numeric_limits<double>::max(), std::numeric_limits<double>::lowest(), std::numeric_limits<double>::lowest()};
+		for (auto const [l, w, h] : {std::array{-1., -1., 0.}, std::array{-1., 1., 0.}, std::array{1., -1., 0.}, std::array{1., 1., 0.}, std::array{-1., -1., 1.}, std::array{-1., 1., 1.}, std::array{1., -1., 1.},
+		         std::array{1., 1., 1.}}) {
+			Eigen::Vector4d corner = Eigen::Vector4d::Ones();
+			corner.head<3>() = position + forward * (l * object.size[2] / 2.) + left * (w * object.size[1] / 2.) + Eigen::Vector3d::UnitZ() * (h * object.size[0]);
+
+			Eigen::Vector3d const projected = config.projection_matrix * corner;
+			if (projected.z() < 0.1) {
+				in_front = false;
+				break;
+			}
+
+			double const u = projected.x() / projected.z();
+			double const v = projected.y() / projected.z();
+			bbox = {std::min(bbox.left, u), std::min(bbox.top, v), std::max(bbox.right, u), std::max(bbox.bottom, v)};
+			depth += projected.z() / 8.;
+		}
+		if (!in_front) continue;
+
+		bbox = {std::max(bbox.left, 0.), std::max(bbox.top, 0.), std::min(bbox.right, static_cast<double>(config.width)), std::min(bbox.bottom, static_cast<double>(config.height))};
+		if (bbox.right - bbox.left < 1. || bbox.bottom - bbox.top < 1.) continue;
+
+		ret.emplace_back(depth, Detection2D{bbox, 1., object.object_class}, object.color);
+	}
+
+	std::ranges::sort(ret, std::ranges::greater{}, &ProjectedObject::depth);
+	return ret;
+}
+
+Detections2D SyntheticScene::detections(std::string const& camera, std::uint64_t const timestamp) const {
+	Detections2D ret{timestamp, camera, {}, {}};
+	for (auto const& projected : project(camera, timestamp)) ret.objects.push_back(projected.detection);
+	return ret;
+}
+
+CompactObjects SyntheticScene::objects(std::uint64_t const timestamp) const {
+	CompactObjects ret{timestamp, {}, {}};
+	ret.objects.reserve(_objects.size());
+	for (auto const& object : _objects) {
+		auto const [position, velocity] = state(object, timestamp);
+
+		Eigen::Vector4d world = _affine_transformation_base_to_utm * Eigen::Vector4d(position.x(), position.y(), position.z(), 1.);
+		Eigen::Vector3d const world_velocity = _affine_transformation_base_to_utm.topLeftCorner<3, 3>() * velocity;
+		double const yaw = std::atan2(world_velocity.y(), world_velocity.x());
+
+		ret.objects.emplace_back(object.id, object.object_class, std::array{world.x(), world.y(), world.z()}, std::array{0., 0., yaw}, object.size, std::array{world_velocity.x(), world_velocity.y(), world_velocity.z()});
+	}
+	return ret;
+}
+
+void SyntheticScene::render(std::string const& camera, std::uint64_t const timestamp, cv::Mat& image) const {
+	auto const& config = _cameras.at(camera);
+	if (image.empty()) image.create(config.height, config.width, CV_8UC3);
+
+	double const scale_x = static_cast<double>(image.cols) / config.width;
+	double const scale_y = static_cast<double>(image.rows) / config.height;
+
+	image.setTo(cv::Scalar(90, 90, 90));
+	for (auto const& [depth, detection, color] : project(camera, timestamp)) {
+		cv::Rect const box(cv::Point(static_cast<int>(detection.bbox.left * scale_x), static_cast<int>(detection.bbox.top * scale_y)),
+		    cv::Point(static_cast<int>(detection.bbox.right * scale_x), static_cast<int>(detection.bbox.bottom * scale_y)));
+		cv::rectangle(image, box, cv::Scalar(color[0], color[1], color[2]), cv::FILLED);
+		cv::rectangle(image, box, cv::Scalar(color[0] / 2, color[1] / 2, color[2] / 2), 1);
+	}
+}
@@ -36,9 +36,12 @@ int main(int argc, char* argv[]) {
 	//     {"s110_s_cam_8", {1200, 1920, cv::ColorConversionCodes::COLOR_BayerBG2BGR}}, {"s110_o_cam_8", {1200, 1920, cv::ColorConversionCodes::COLOR_BayerBG2BGR}}});
 	// ImageSavingNode img([](ImageData const& data) { return data.source == "s110_s_cam_8"; });
 
-	BaslerCamerasNode cameras({{"s60_n_cam_16_k", {"00305338063B"}}, {"s60_n_cam_50_k", {"0030532A9B7D"}}});
+	// every camera is grabbed in its own thread with real-time priority, so that a loaded system does not drop frames
+	BaslerCamerasNode cameras({{"s60_n_cam_16_k", {"00305338063B"}}, {"s60_n_cam_50_k", {"0030532A9B7D"}}}, ThreadPlacementConfig{.cpus = {}, .policy = SchedulingPolicy::fifo, .priority = 80}, 4, GrabMode::per_camera);
 	ImagePreprocessingNode pre({{"s60_n_cam_16_k", {1200, 1920, cv::ColorConversionCodes::COLOR_BayerBG2BGR}}, {"s60_n_cam_50_k", {1200, 1920, cv::ColorConversionCodes::COLOR_BayerBG2BGR}}});
-	ImageSavingNode save({{"s60_n_cam_16_k", {std::filesystem::path(CMAKE_SOURCE_DIR) / "result" / "s60_n_cam_16_k"}}, {"s60_n_cam_50_k", {std::filesystem::path(CMAKE_SOURCE_DIR) / "result" / "s60_n_cam_50_k"}}});
+	// the images of both cameras are encoded in parallel, frames are dropped and counted if the disk cannot keep up
+	ImageSavingNode save({{"s60_n_cam_16_k", {std::filesystem::path(CMAKE_SOURCE_DIR) / "result" / "s60_n_cam_16_k"}}, {"s60_n_cam_50_k", {std::filesystem::path(CMAKE_SOURCE_DIR) / "result" / "s60_n_cam_50_k"}}},
+	    AsyncWriterConfig{.queue_capacity = 32, .threads = 4}, JpegConfig{.quality = 90, .sampling_factor = cv::IMWRITE_JPEG_SAMPLING_FACTOR_420});
 
 	// BaslerCamerasNode cameras({{"car_cam_16", BaslerCamerasNode::MacAddressConfig{"0030534C1B61"}}});
 	// ImagePreprocessingNode pre({{"car_cam_16", {1200, 1920, cv::ColorConversionCodes::COLOR_BayerBG2BGR}}});
@@ -53,5 +56,9 @@ int main(int argc, char* argv[]) {
 
 	std::this_thread::sleep_for(20s);
 
+	print_thread_placement_report();
+	cameras.print_statistics();
+	save.print_statistics();
+
 	clean_up(0);
 }
\ No newline at end of file
@@ -1,15 +1,142 @@
+#include <algorithm>
+#include <atomic>
 #include <chrono>
+#include <condition_variable>
 #include <filesystem>
 #include <map>
+#include <mutex>
+#include <utility>
+#include <vector>
 
 #include "CamerasSimulatorNode.h"
+#include "GrabBuffer.h"
 #include "ImagePreprocessingNode.h"
 #include "ImageVisualizationNode.h"
 #include "RawDataCamerasSimulatorNode.h"
+#include "RawRecording.h"
+#include "RawRecordingCamerasSimulatorNode.h"
+#include "Runner.h"
 #include "common_output.h"
 
 using namespace std::chrono_literals;
 
+/**
+ * @brief Counts the replayed images and checks that the recorded timestamps of every camera are increasing.
+ */
+class ReplayCountingNode : public Runner<ImageData> {
+	std::map<std::string, std::uint64_t> _last_timestamp;
+
+   public:
+	std::atomic<std::uint64_t> received = 0;
+
+	void run(ImageData const& data) final {
+		if (auto& last_timestamp = _last_timestamp[data.source]; data.timestamp < last_timestamp)
+			common::println_critical_loc("Replayed image of ", data.source, " with timestamp ", data.timestamp, " is older than ", last_timestamp, '!');
+		else
+			last_timestamp = data.timestamp;
+
+		++received;
+	}
+};
+
+/**
+ * @brief Checks that the frames of the raw recording arrive complete and in the order they were written.
+ */
+class RawRecordingCheckNode : public Runner<ImageDataRaw> {
+   public:
+	std::atomic<std::uint64_t> received = 0;
+
+	void run(ImageDataRaw const& data) final {
+		// the first pass keeps the recorded timestamps, every frame was filled with its number
+		if (std::uint64_t const number = data.timestamp / 10'000'000; number < 64 && (data.image_raw.size() != 100'000 || std::ranges::any_of(data.image_raw, [&](std::uint8_t const byte) { return byte != number; })))
+			common::println_critical_loc("Frame ", number, " of the raw recording is corrupted!");
+
+		++received;
+	}
+};
+
+/**
+ * @brief Hands out frames from a fixed pool of buffers like pylon does, a buffer is only reused after the handle of its grab result was destroyed.
+ */
+class FakeGrabBufferProvider : public Pusher<ImageDataRaw> {
+	std::vector<std::vector<std::uint8_t>> _buffers;
+	std::mutex _mutex;
+	std::condition_variable _returned;
+	std::vector<std::size_t> _free;
+	std::uint64_t _count = 0;
+
+	class GrabResult {
+		FakeGrabBufferProvider* _provider;
+		std::size_t _buffer;
+
+	   public:
+		GrabResult(FakeGrabBufferProvider* provider, std::size_t const buffer) : _provider(provider), _buffer(buffer) {}
+		GrabResult(GrabResult&& other) noexcept : _provider(std::exchange(other._provider, nullptr)), _buffer(other._buffer) {}
+
+		~GrabResult() {
+			if (!_provider) return;
+
+			std::scoped_lock lock(_provider->_mutex);
+			_provider->_free.push_back(_buffer);
+			_provider->_returned.notify_one();
+		}
+	};
+
+	ImageDataRaw push() final {
+		std::this_thread::sleep_for(2ms);
+
+		std::unique_lock lock(_mutex);
+		_returned.wait(lock, [this] { return !_free.empty(); });
+		std::size_t const buffer = _free.back();
+		_free.pop_back();
+		lock.unlock();
+
+		std::ranges::fill(_buffers[buffer], static_cast<std::uint8_t>(_count));
+
+		ImageDataRaw data;
+		data.image_raw = make_grab_buffer(GrabResult(this, buffer), _buffers[buffer].data(), _buffers[buffer].size());
+		data.timestamp = ++_count;
+		data.source = "s110_n_cam_8";
+		return data;
+	}
+
+   public:
+	explicit FakeGrabBufferProvider(std::size_t const buffers) : _buffers(buffers, std::vector<std::uint8_t>(1200 * 1920)) {
+		for (std::size_t i = 0; i < buffers; ++i) _free.push_back(i);
+	}
+
+	/**
+	 * @return True, if the raw image references one of the grab buffers instead of a copy.
+	 */
+	bool owns(RawBuffer const& raw) const {
+		return std::ranges::any_of(_buffers, [&raw](std::vector<std::uint8_t> const& buffer) { return raw.data() == buffer.data(); });
+	}
+
+	std::size_t free_buffers() {
+		std::scoped_lock lock(_mutex);
+		return _free.size();
+	}
+};
+
+/**
+ * @brief Checks that the raw images arrive without being copied.
+ */
+class ZeroCopyCheckNode : public Runner<ImageDataRaw> {
+	FakeGrabBufferProvider const& _provider;
+
+   public:
+	std::atomic<std::uint64_t> received = 0;
+
+	explicit ZeroCopyCheckNode(FakeGrabBufferProvider const& provider) : _provider(provider) {}
+
+	void run(ImageDataRaw const& data) final {
+		if (!_provider.owns(data.image_raw)) common::println_critical_loc("Raw image was copied on its way from the grab buffer!");
+		if (data.image_raw.data()[0] != static_cast<std::uint8_t>(data.timestamp - 1)) common::println_critical_loc("Grab buffer was reused while the raw image was still alive!");
+
+		++received;
+	}
+};
+
 int main(int argc, char* argv[]) {
 	gtk_init(&argc, &argv);
 
@@ -36,6 +163,102 @@ int main(int argc, char* argv[]) {
 		for (auto timestamp = std::chrono::system_clock::now() + 10s; std::chrono::system_clock::now() < timestamp; std::this_thread::yield()) g_main_context_iteration(NULL, true);
 	}
 
+	for (auto const& replay : {ReplayConfig{.mode = ReplayMode::as_fast_as_possible}, ReplayConfig{.mode = ReplayMode::real_time, .time_scale = 10.},
+	         ReplayConfig{.mode = ReplayMode::as_fast_as_possible, .cache_budget = std::size_t{1} << 30}}) {
+		CamerasSimulatorNode cams =
+		    make_cameras_simulator_node_tumtraf({{"s110_n_cam_8", std::filesystem::path(CMAKE_SOURCE_DIR) / "data" / "tumtraf_v2x_cooperative_perception_dataset" / "test" / "images" / "s110_camera_basler_north_8mm"},
+		                                            {"s110_o_cam_8", std::filesystem::path(CMAKE_SOURCE_DIR) / "data" / "tumtraf_v2x_cooperative_perception_dataset" / "test" / "images" / "s110_camera_basler_east_8mm"}},
+		        replay);
+		ReplayCountingNode count;
+
+		cams.synchronously_connect(count);
+
+		auto cameras_thread = cams();
+
+		std::this_thread::sleep_for(5s);
+
+		common::println(replay.mode == ReplayMode::as_fast_as_possible ? "as fast as possible" : "real time", " replay at time scale ", replay.time_scale, ": ", count.received.load() / 5., " images/s");
+		cams.print_cache_statistics();
+		if (count.received == 0) common::println_critical_loc("Replay did not output anything!");
+		if (auto const cache = cams.cache_statistics(); cache && cache->used > cache->budget) common::println_critical_loc("Decoded frame cache uses ", cache->used, " of ", cache->budget, " bytes!");
+	}
+
+	{
+		// a budget for 4 of the 8 images as they are and one compressed image, so that the cache also has to compress and reject images
+		constexpr std::size_t images = 8;
+		constexpr std::size_t image_bytes = 48 * 64 * 3;
+		auto const folder = std::filesystem::temp_directory_path() / "test_cameras_simulator_nodes_cache";
+		std::filesystem::create_directories(folder);
+
+		std::vector<CamerasSimulatorNode::FilepathArrivedRecordedSourceConfig> files;
+		for (std::uint64_t i = 0; i < images; ++i) {
+			auto const path = folder / (std::to_string(i) + ".png");
+			cv::imwrite(path.string(), cv::Mat(48, 64, CV_8UC3, cv::Scalar::all(static_cast<double>(i * 16))));
+			files.emplace_back(path, i * 10'000'000, i * 10'000'000, "s110_n_cam_8");
+		}
+
+		// without prefetching, an image of the second pass is only looked up after the first pass inserted it
+		CamerasSimulatorNode cams(std::move(files), {.mode = ReplayMode::as_fast_as_possible, .prefetch_depth = 0, .cache_budget = 4 * image_bytes + image_bytes / 2 + image_bytes / 4});
+		ReplayCountingNode count;
+
+		cams.synchronously_connect(count);
+
+		{
+			auto cameras_thread = cams();
+
+			for (auto const timeout = std::chrono::steady_clock::now() + 5s; count.received < 3 * images && std::chrono::steady_clock::now() < timeout; std::this_thread::sleep_for(1ms)) {
+				if (auto const cache = cams.cache_statistics(); cache->used > cache->budget) common::println_critical_loc("Decoded frame cache uses ", cache->used, " of ", cache->budget, " bytes!");
+			}
+		}
+
+		cams.print_cache_statistics();
+		auto const cache = cams.cache_statistics();
+		if (count.received < 3 * images) common::println_critical_loc("Cached replay did not loop over the images!");
+		if (cache->used > cache->budget) common::println_critical_loc("Decoded frame cache uses ", cache->used, " of ", cache->budget, " bytes!");
+		if (!cache->hits || !cache->compressed_hits) common::println_critical_loc("Second pass of the cached replay did not hit the cache!");
+		if (!cache->rejected) common::println_critical_loc("Decoded frame cache did not reject the images that do not fit into the budget!");
+	}
+
+	{
+		FakeGrabBufferProvider grabber(grab_buffer_count(4));
+		ZeroCopyCheckNode check(grabber);
+		ImagePreprocessingNode grab_pre({{"s110_n_cam_8", {1200, 1920, cv::ColorConversionCodes::COLOR_BayerBG2BGR}}});
+
+		grabber.synchronously_connect(check);
+		grabber.synchronously_connect(grab_pre);
+
+		{
+			auto grabber_thread = grabber();
+
+			std::this_thread::sleep_for(1s);
+		}
+
+		common::println("zero copy grabbing passed ", check.received.load(), " frames, ", grabber.free_buffers(), " of ", grab_buffer_count(4), " grab buffers returned");
+		if (check.received == 0) common::println_critical_loc("Fake grab buffer provider did not output anything!");
+		if (grabber.free_buffers() != grab_buffer_count(4)) common::println_critical_loc("Grab buffers were not returned after the pipeline released the raw images!");
+	}
+
+	{
+		auto const folder = std::filesystem::temp_directory_path() / "test_cameras_simulator_nodes_recording";
+		{
+			// small segments, so that the recording spans several of them
+			RawRecordingWriter writer(folder, 1 << 20);
+			for (std::uint64_t i = 0; i < 64; ++i) writer.append(i % 2 ? "s110_n_cam_8" : "s110_s_cam_8", i * 10'000'000, i * 10'000'000, std::vector<std::uint8_t>(100'000, static_cast<std::uint8_t>(i)));
+		}
+
+		RawRecordingCamerasSimulatorNode recorded_cams(folder, {.mode = ReplayMode::as_fast_as_possible});
+		RawRecordingCheckNode check;
+
+		recorded_cams.synchronously_connect(check);
+
+		auto recorded_cameras_thread = recorded_cams();
+
+		std::this_thread::sleep_for(1s);
+
+		common::println("raw recording replayed ", check.received.load(), " frames");
+		if (check.received < 64) common::println_critical_loc("Raw recording was not replayed completely!");
+	}
+
 	{
 		RawDataCamerasSimulatorNode raw_cams = make_raw_data_cameras_simulator_node_arrived_recorded1({{"s110_s_cam_8", std::filesystem::path(CMAKE_SOURCE_DIR) / "data" / "s110_cams_raw" / "s110_s_cam_8"}});
 		ImagePreprocessingNode pre({{"s110_n_cam_8", {1200, 1920, cv::ColorConversionCodes::COLOR_BayerBG2BGR}}, {"s110_w_cam_8", {1200, 1920, cv::ColorConversionCodes::COLOR_BayerBG2BGR}},
@@ -0,0 +1,109 @@
+#include <atomic>
+#include <chrono>
+#include <map>
+#include <memory>
+#include <string>
+#include <thread>
+#include <utility>
+
+#include "ImagePreprocessingNode.h"
+#include "Runner.h"
+#include "SyntheticCamerasNode.h"
+#include "common_output.h"
+#include "config.h"
+
+using namespace std::chrono_literals;
+
+/**
+ * @brief Checks the rendered images against the ground truth of the synthetic scene: the nearest object must be visible in the center of its box.
+ */
+class SyntheticCheckNode : public Runner<ImageData> {
+	std::shared_ptr<SyntheticScene const> _scene;
+
+   public:
+	std::atomic<std::uint64_t> received = 0;
+	std::atomic<std::uint64_t> detections = 0;
+
+	explicit SyntheticCheckNode(std::shared_ptr<SyntheticScene const> scene) : _scene(std::move(scene)) {}
+
+	void run(ImageData const& data) final {
+		auto const ground_truth = _scene->detections(data.source, data.timestamp);
+		auto const& camera = _scene->cameras().at(data.source);
+
+		if (!ground_truth.objects.empty()) {
+			auto const& nearest = ground_truth.objects.back().bbox;
+			double const scale_x = static_cast<double>(data.image.cols) / camera.width;
+			double const scale_y = static_cast<double>(data.image.rows) / camera.height;
+
+			// boxes of a few pixels are blurred away by the demosaicing of the raw images
+			if ((nearest.right - nearest.left) * scale_x >= 8. && (nearest.bottom - nearest.top) * scale_y >= 8.) {
+				auto const pixel = data.image.at<cv::Vec3b>(static_cast<int>((nearest.top + nearest.bottom) / 2. * scale_y), static_cast<int>((nearest.left + nearest.right) / 2. * scale_x));
+				if (pixel == cv::Vec3b(90, 90, 90)) common::println_critical_loc("Nearest object of ", data.source, " is not rendered at ", data.timestamp, '!');
+			}
+		}
+
+		detections += ground_truth.objects.size();
+		++received;
+	}
+};
+
+/**
+ * @brief Counts the messages and the objects of a synthetic node.
+ */
+template <typename T>
+class SyntheticCountingNode : public Runner<T> {
+   public:
+	std::atomic<std::uint64_t> received = 0;
+	std::atomic<std::uint64_t> objects = 0;
+
+	void run(T const& data) final {
+		if constexpr (requires { data->objects; })
+			objects += data->objects.size();
+		else
+			objects += data.objects.size();
+		++received;
+	}
+};
+
+int main() {
+	{
+		auto const scene = std::make_shared<SyntheticScene const>(
+		    std::map<std::string, SyntheticCameraConfig>{{"s110_n_cam_8", {config::projection_matrix_s110_base_north_into_s110_n_cam_8, config::height_s110_n_cam_8, config::width_s110_n_cam_8}},
+		        {"s110_o_cam_8", {config::projection_matrix_s110_base_north_into_s110_o_cam_8, config::height_s110_o_cam_8, config::width_s110_o_cam_8}},
+		        {"s110_s_cam_8", {config::projection_matrix_s110_base_north_into_s110_s_cam_8, config::height_s110_s_cam_8, config::width_s110_s_cam_8}},
+		        {"s110_w_cam_8", {config::projection_matrix_s110_base_north_into_s110_w_cam_8, config::height_s110_w_cam_8, config::width_s110_w_cam_8}}},
+		    SyntheticSceneConfig{.objects = 50, .seed = 0, .affine_transformation_base_to_utm = config::affine_transformation_utm_to_s110_base_north});
+
+		SyntheticCamerasNode<ImageData> synthetic_cams(scene, 15., 600, 960);
+		SyntheticCamerasNode<ImageDataRaw> synthetic_raw_cams(scene, 15.);
+		SyntheticCamerasNode<Detections2D> synthetic_detections(scene, 15.);
+		SyntheticObjectsNode synthetic_objects(scene, 15.);
+
+		ImagePreprocessingNode synthetic_pre({{"s110_n_cam_8", {1200, 1920, cv::ColorConversionCodes::COLOR_BayerBG2BGR}}, {"s110_w_cam_8", {1200, 1920, cv::ColorConversionCodes::COLOR_BayerBG2BGR}},
+		    {"s110_s_cam_8", {1200, 1920, cv::ColorConversionCodes::COLOR_BayerBG2BGR}}, {"s110_o_cam_8", {1200, 1920, cv::ColorConversionCodes::COLOR_BayerBG2BGR}}});
+		SyntheticCheckNode check(scene);
+		SyntheticCheckNode raw_check(scene);
+		SyntheticCountingNode<Detections2D> count_detections;
+		SyntheticCountingNode<Shared<CompactObjects>> count_objects;
+
+		synthetic_cams.synchronously_connect(check);
+		synthetic_raw_cams.synchronously_connect(synthetic_pre).synchronously_connect(raw_check);
+		synthetic_detections.synchronously_connect(count_detections);
+		synthetic_objects.synchronously_connect(count_objects);
+
+		{
+			auto synthetic_cameras_thread = synthetic_cams();
+			auto synthetic_raw_cameras_thread = synthetic_raw_cams();
+			auto synthetic_detections_thread = synthetic_detections();
+			auto synthetic_objects_thread = synthetic_objects();
+
+			std::this_thread::sleep_for(2s);
+		}
+
+		common::println("synthetic scene rendered ", check.received.load(), " images with ", check.detections.load(), " ground truth boxes, ", raw_check.received.load(), " raw images, ", count_detections.received.load(),
+		    " ground truth detections and ", count_objects.received.load(), " ground truth world states");
+		if (check.received == 0 || raw_check.received == 0 || count_detections.received == 0 || count_objects.received == 0) common::println_critical_loc("Synthetic nodes did not output anything!");
+		if (check.detections == 0) common::println_critical_loc("No synthetic object is in the view of the cameras!");
+		if (count_objects.objects != 50 * count_objects.received) common::println_critical_loc("Ground truth world states do not contain every object!");
+	}
+}
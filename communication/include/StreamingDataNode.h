@@ -5,7 +5,9 @@
 #include <chrono>
 
 #include "CompactObject.h"
+#include "LatencyTracer.h"
 #include "Runner.h"
+#include "Shared.h"
 #include "common_output.h"
 #include "yas.h"
 
@@ -15,7 +17,7 @@ using namespace std::chrono_literals;
  * @class StreamingDataNode
  * @brief A class responsible for handling streaming data and publishing it to an MQTT broker.
  */
-class StreamingDataNode : public Runner<CompactObjects> {
+class StreamingDataNode : public Runner<Shared<CompactObjects>> {
 	struct mosquitto *mosq;
 
    public:
@@ -44,16 +46,20 @@ class StreamingDataNode : public Runner<CompactObjects> {
 	/**
 	 * @brief Publishes serialized compact object data to the MQTT topic "objects".
 	 *
-	 * @param data The CompactObjects instance to serialize and publish.
+	 * @param data The shared CompactObjects instance to serialize and publish.
 	 */
-	void run(CompactObjects const &data) final {
+	void run(Shared<CompactObjects> const &data) final {
+		static auto &stage = latency_stage("data_stream");
+		TraceScope scope(stage, data->trace);
+
 		yas::mem_ostream os;
 		yas::binary_oarchive<yas::mem_ostream> oa(os);
-		oa.serialize(data);
+		oa.serialize(*data);
 
 		if (int ret = mosquitto_publish(mosq, nullptr, "objects", os.get_intrusive_buffer().size, os.get_intrusive_buffer().data, 0, false); ret != MOSQ_ERR_SUCCESS) {
 			common::println_warn_loc("Failed to publish message: ", mosquitto_strerror(ret), '!');
 		}
+		scope.finish(data->timestamp);
 
 		for (;;) {
 			if (int ret2 = mosquitto_loop(mosq, 1000, 1); ret2 != MOSQ_ERR_SUCCESS) {
@@ -9,11 +9,11 @@
 
 using namespace std::chrono_literals;
 
-class GenerateCompactObjects : public Pusher<CompactObjects> {
-	CompactObjects push() final {
+class GenerateCompactObjects : public Pusher<Shared<CompactObjects>> {
+	Shared<CompactObjects> push() final {
 		std::this_thread::sleep_for(50ms);
 		std::uint64_t now = std::chrono::time_point_cast<std::chrono::nanoseconds>(std::chrono::system_clock::now()).time_since_epoch().count();
-		return CompactObjects{now, {}};
+		return make_shared_message(CompactObjects{now, {}});
 	}
 };
 
@@ -0,0 +1,138 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <optional>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "BoundedQueue.h"
+#include "common_output.h"
+
+/**
+ * @brief Configures the queue and the threads of an AsyncWriter.
+ */
+struct AsyncWriterConfig {
+	std::size_t queue_capacity = 64;                                    // frames buffered in memory before new frames are dropped
+	std::size_t threads = 4;                                            // number of threads that encode and write in parallel
+	std::chrono::nanoseconds late_threshold = std::chrono::seconds(1);  // frames written later than this after they were queued count as late
+};
+
+/**
+ * @brief Counters of an AsyncWriter. They can be read from any thread while the writer is in use.
+ */
+struct WriterStatistics {
+	std::atomic<std::uint64_t> queued = 0;   ///< Number of frames accepted into the queue.
+	std::atomic<std::uint64_t> dropped = 0;  ///< Number of frames discarded because the queue was full.
+	std::atomic<std::uint64_t> written = 0;  ///< Number of frames written to disk.
+	std::atomic<std::uint64_t> late = 0;     ///< Number of written frames that exceeded the late threshold.
+	std::atomic<std::uint64_t> failed = 0;   ///< Number of frames that could not be encoded or written.
+	std::atomic<std::uint64_t> bytes = 0;    ///< Number of bytes written.
+};
+
+/**
+ * @brief Writes the bytes to a new file with one sequential write.
+ *
+ * @return True, if the file was written completely.
+ */
+bool write_file(std::filesystem::path const& path, std::uint8_t const* data, std::size_t size);
+
+/**
+ * @class AsyncWriter
+ * @brief Takes frames from a node thread and writes them to disk in a pool of threads, so that a slow disk never blocks the node.
+ *
+ * The node thread only enqueues the frame. If the queue is full, the frame is dropped and counted instead of waiting for the disk.
+ * The frames still in the queue are written before the writer is destroyed.
+ *
+ * @tparam Data The frame type.
+ */
+template <typename Data>
+class AsyncWriter {
+	struct Job {
+		std::filesystem::path path;
+		Data data;
+		std::chrono::steady_clock::time_point queued;
+	};
+
+	std::string _name;
+	AsyncWriterConfig _config;
+	std::function<std::size_t(std::filesystem::path const&, Data const&)> _write;
+
+	// frames are dropped before the queue gets full, so it never blocks the node thread
+	BoundedQueue<Job> _queue;
+	WriterStatistics _statistics;
+
+	std::vector<std::jthread> _threads;
+
+	void work() {
+		while (auto job = _queue.pop()) {
+			std::size_t const bytes = _write(job->path, job->data);
+			if (!bytes) {
+				_statistics.failed.fetch_add(1, std::memory_order_relaxed);
+				continue;
+			}
+
+			_statistics.written.fetch_add(1, std::memory_order_relaxed);
+			_statistics.bytes.fetch_add(bytes, std::memory_order_relaxed);
+			if (std::chrono::steady_clock::now() - job->queued > _config.late_threshold) _statistics.late.fetch_add(1, std::memory_order_relaxed);
+		}
+	}
+
+   public:
+	/**
+	 * @param name The name in the statistics output.
+	 * @param config The size of the queue, the number of threads and the late threshold.
+	 * @param write Encodes and writes one frame to the path, returns the number of bytes written or 0 on failure. It is called from all threads at the same time.
+	 */
+	AsyncWriter(std::string name, AsyncWriterConfig const& config, std::function<std::size_t(std::filesystem::path const&, Data const&)> write)
+	    : _name(std::move(name)), _config(config), _write(std::move(write)), _queue(std::max<std::size_t>(config.queue_capacity, 1), OverflowPolicy::block) {
+		if (!_config.threads) common::println_critical_loc("An asynchronous writer needs at least one thread!");
+		for (std::size_t i = 0; i < _config.threads; ++i) _threads.emplace_back([this] { work(); });
+	}
+
+	~AsyncWriter() { _queue.close(); }
+
+	AsyncWriter(AsyncWriter const&) = delete;
+	AsyncWriter& operator=(AsyncWriter const&) = delete;
+
+	/**
+	 * @brief Enqueues the frame to be written to the path.
+	 *
+	 * @return True, if the frame was enqueued, false if it was dropped.
+	 */
+	bool push(std::filesystem::path path, Data data) {
+		return push_lazily(std::move(path), [&data] { return std::move(data); });
+	}
+
+	/**
+	 * @brief Enqueues the frame that make_data returns, make_data is only called if the frame is not dropped, e.g. to copy a buffer only if it is written.
+	 *
+	 * Only the node thread pushes, so the queue cannot fill up between the check and the push.
+	 *
+	 * @return True, if the frame was enqueued, false if it was dropped.
+	 */
+	template <typename MakeData>
+	bool push_lazily(std::filesystem::path path, MakeData&& make_data) {
+		if (_queue.size() >= _queue.capacity()) {
+			_statistics.dropped.fetch_add(1, std::memory_order_relaxed);
+			return false;
+		}
+
+		_queue.push(Job{std::move(path), std::forward<MakeData>(make_data)(), std::chrono::steady_clock::now()});
+		_statistics.queued.fetch_add(1, std::memory_order_relaxed);
+		return true;
+	}
+
+	[[nodiscard]] WriterStatistics const& statistics() const { return _statistics; }
+
+	void print_statistics() const {
+		common::println(_name, ": written ", _statistics.written.load(), " (", _statistics.bytes.load() / 1e6, " MB), dropped ", _statistics.dropped.load(), ", late ", _statistics.late.load(), ", failed ",
+		    _statistics.failed.load(), ", queue high water ", _queue.statistics().high_water.load(), '/', _queue.capacity());
+	}
+};
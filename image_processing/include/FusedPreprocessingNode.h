@@ -0,0 +1,112 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <map>
+#include <opencv2/opencv.hpp>
+#include <string>
+#include <vector>
+
+#include "ImageData.h"
+#include "ImageDataRaw.h"
+#include "LatencyTracer.h"
+#include "Processor.h"
+#include "common_output.h"
+
+/**
+ * @brief Describes the raw images of a camera and how they are undistorted.
+ */
+struct FusedPreprocessingConfig {
+	int height;                                      // height of the raw image
+	int width;                                       // width of the raw image
+	cv::ColorConversionCodes color_conversion_code;  // bayer pattern, same as for ImagePreprocessingNode
+	cv::Mat undistortion_map1;                       // CV_32FC1 x map of cv::initUndistortRectifyMap, empty to skip the undistortion
+	cv::Mat undistortion_map2;                       // CV_32FC1 y map of cv::initUndistortRectifyMap
+};
+
+/**
+ * @brief Maps every pixel of the letterboxed output to the bayer samples of the raw image it is averaged from.
+ *
+ * Every bayer channel is sampled at every second pixel in both directions, so the samples of a channel only depend on whether it sits in the even or the odd columns and rows.
+ * For both, every output pixel has the first sample and taps weights per direction, the samples of a channel are the taps x taps grid starting at the first sample with a spacing of 2 pixels.
+ */
+struct FusedPreprocessingLut {
+	struct Entry {
+		std::array<std::int32_t, 2> cols;  // first column of the samples in the even and in the odd columns, -1 for the letterbox border
+		std::array<std::int32_t, 2> rows;  // first row of the samples in the even and in the odd rows
+	};
+
+	int raw_height;
+	int raw_width;
+	int taps;                            // samples per direction that the footprint of an output pixel covers
+	std::array<cv::Point, 4> channels;   // positions of blue, green 1, green 2 and red within a quad
+	std::vector<Entry> entries;          // row-major, one per output pixel
+	std::vector<std::uint16_t> weights;  // per output pixel the horizontal weights of the even and odd columns, then the vertical weights of the even and odd rows, in 1/1024
+};
+
+/**
+ * @brief Precomputes the lookup table from the letterboxed output image back into the raw bayer image.
+ *
+ * The letterbox geometry is the same as in ImageDownscalingNode, so that the detections are scaled back in the same way.
+ *
+ * @param config The size, bayer pattern and undistortion of the raw images.
+ * @param height The height of the output image.
+ * @param width The width of the output image.
+ */
+FusedPreprocessingLut make_fused_preprocessing_lut(FusedPreprocessingConfig const& config, int height, int width);
+
+/**
+ * @brief Demosaics, undistorts and letterboxes the raw image in one pass over the output image.
+ *
+ * @param lut The lookup table of the camera.
+ * @param raw The raw bayer image.
+ * @param image The CV_8UC3 output image of the size the lookup table was made for.
+ */
+void apply_fused_preprocessing_lut(FusedPreprocessingLut const& lut, std::uint8_t const* raw, cv::Mat& image);
+
+/**
+ * @class FusedPreprocessingNode
+ * @brief Turns raw bayer images into inference-ready letterboxed images in a single pass.
+ *
+ * Replaces ImagePreprocessingNode, ImageUndistortionNode and ImageDownscalingNode on the path from the cameras to the detector.
+ * Instead of three full resolution intermediate images, every output pixel is averaged from the bayer samples under its footprint in the raw image, which is looked up in a per camera table.
+ * Every channel is interpolated from its own samples, so the channels are not shifted against each other, and the footprint is averaged like cv::INTER_AREA does, so the downscaling does not alias.
+ *
+ * @tparam height The height of the output image.
+ * @tparam width The width of the output image.
+ */
+template <int height, int width>
+class FusedPreprocessingNode : public Processor<ImageDataRaw, ImageData> {
+	std::map<std::string, FusedPreprocessingLut> _luts;
+
+   public:
+	/**
+	 * @param configs A map that maps the names of the cameras to the size, bayer pattern and undistortion of their raw images.
+	 */
+	explicit FusedPreprocessingNode(std::map<std::string, FusedPreprocessingConfig> const& configs) {
+		for (auto const& [camera, config] : configs) _luts.emplace(camera, make_fused_preprocessing_lut(config, height, width));
+	}
+
+	/**
+	 * @brief Demosaics, undistorts and downscales the raw image in letterbox style.
+	 *
+	 * @param data The raw image.
+	 * @return The letterboxed image.
+	 */
+	ImageData process(ImageDataRaw const& data) final {
+		static auto& stage = latency_stage("fused pre");
+		TraceScope scope(stage);
+
+		auto const& lut = _luts.at(data.source);
+		if (data.image_raw.size() != static_cast<std::size_t>(lut.raw_height) * lut.raw_width) common::println_critical_loc("The raw image does not match the configured size!");
+
+		ImageData ret;
+		ret.timestamp = data.timestamp;
+		ret.source = data.source;
+		ret.image.create(height, width, CV_8UC3);
+		apply_fused_preprocessing_lut(lut, data.image_raw.data(), ret.image);
+
+		ret.trace = scope.finish(ret.timestamp);
+		return ret;
+	}
+};
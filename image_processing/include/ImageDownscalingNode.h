@@ -1,18 +1,127 @@
 #pragma once
 
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
 #include <opencv2/opencv.hpp>
+#include <vector>
 
 #include "ImageData.h"
+#include "LatencyTracer.h"
 #include "Processor.h"
 
+/**
+ * @brief Describes the layout of the downscaled image.
+ */
+enum class DownscalingOutput {
+	bgr,       ///< CV_8UC3 image of size height x width.
+	chw_float  ///< CV_32FC1 image of size 3 * height x width that holds the blue, green and red planes one after another, normalized to [0, 1], i.e. the input tensor of yolo.
+};
+
+namespace downscaling {
+	/**
+	 * @brief Averages factor x factor blocks of the BGR input and writes them into the letterboxed output.
+	 *
+	 * The block size is known at compile time, so the loops over the block are unrolled.
+	 * The rows of a block are summed in plain loops over contiguous bytes, which the compiler vectorizes with -O3, i.e. in release builds.
+	 * The columns of a block are summed per channel of the interleaved BGR pixels, these loops stay scalar.
+	 * The rounding matches cv::resize with cv::INTER_AREA for integer scale factors, which rounds 2x2 blocks half up and larger blocks half to even.
+	 *
+	 * @param row_sums Scratch buffer that is reused between calls.
+	 */
+	template <int factor, DownscalingOutput output>
+	void box_downscale(cv::Mat const& input, cv::Mat& ret, int const height, int const top, int const left, std::vector<std::uint16_t>& row_sums) {
+		int const new_shape_h = input.rows / factor;
+		int const new_shape_w = input.cols / factor;
+		std::size_t const row_size = static_cast<std::size_t>(input.cols) * 3;
+		row_sums.resize(row_size);
+
+		for (int y = 0; y < new_shape_h; ++y) {
+			std::uint8_t const* input_row = input.ptr<std::uint8_t>(y * factor);
+			for (std::size_t i = 0; i < row_size; ++i) row_sums[i] = input_row[i];
+			for (int k = 1; k < factor; ++k) {
+				input_row = input.ptr<std::uint8_t>(y * factor + k);
+				for (std::size_t i = 0; i < row_size; ++i) row_sums[i] += input_row[i];
+			}
+
+			if constexpr (output == DownscalingOutput::bgr) {
+				constexpr unsigned area = factor * factor;
+				auto* ret_row = ret.ptr<std::uint8_t>(top + y) + static_cast<std::size_t>(left) * 3;
+				for (int x = 0; x < new_shape_w; ++x) {
+					for (int c = 0; c < 3; ++c) {
+						unsigned sum = 0;
+						for (int k = 0; k < factor; ++k) sum += row_sums[(x * factor + k) * 3 + c];
+						unsigned const quotient = sum / area;
+						unsigned const remainder = 2 * (sum % area);
+						ret_row[x * 3 + c] = static_cast<std::uint8_t>(quotient + (remainder > area || (remainder == area && (factor == 2 || quotient % 2))));
+					}
+				}
+			} else {
+				constexpr float normalization = 1.f / (255.f * factor * factor);
+				float* planes[3] = {ret.ptr<float>(top + y) + left, ret.ptr<float>(height + top + y) + left, ret.ptr<float>(2 * height + top + y) + left};
+				for (int x = 0; x < new_shape_w; ++x) {
+					for (int c = 0; c < 3; ++c) {
+						unsigned sum = 0;
+						for (int k = 0; k < factor; ++k) sum += row_sums[(x * factor + k) * 3 + c];
+						planes[c][x] = static_cast<float>(sum) * normalization;
+					}
+				}
+			}
+		}
+	}
+}  // namespace downscaling
+
 /**
  * @class ImageDownscalingNode
  * @brief This class performs downscaling.
+ *
+ * If the image is an integer multiple of the letterboxed size, e.g. 1200x1920 to 480x640, it is downscaled with a box filter that is specialized for the scale factor.
+ * Otherwise, cv::resize with cv::INTER_AREA is used.
+ * The output images come from a small pool and are reused as soon as no other node holds them anymore.
+ *
  * @tparam height The height the image is downscaled to.
  * @tparam width The width the image is downscaled to.
+ * @tparam output The layout of the downscaled image, DownscalingOutput::chw_float can be handed to YoloNode without any conversion.
  */
-template <int height, int width>
+template <int height, int width, DownscalingOutput output = DownscalingOutput::bgr>
 class ImageDownscalingNode : public Processor<ImageData, ImageData> {
+	static constexpr std::size_t max_buffers = 8;
+
+	std::vector<cv::Mat> _buffers;
+	std::vector<std::uint16_t> _row_sums;
+	cv::Mat _resized;
+
+	/**
+	 * @brief Returns a buffer of the pool that is not referenced anywhere else or a new one if all are in use.
+	 */
+	cv::Mat acquire_buffer() {
+		for (auto const& buffer : _buffers) {
+			if (buffer.u && buffer.u->refcount == 1) return buffer;
+		}
+
+		cv::Mat buffer = output == DownscalingOutput::bgr ? cv::Mat(height, width, CV_8UC3) : cv::Mat(3 * height, width, CV_32FC1);
+		if (_buffers.size() < max_buffers) _buffers.push_back(buffer);
+		return buffer;
+	}
+
+	/**
+	 * @brief Fills the rows and columns around the downscaled image with the letterbox color 114.
+	 */
+	static void fill_border(cv::Mat& ret, int const top, int const left, int const new_shape_h, int const new_shape_w) {
+		auto const fill = [&](cv::Mat plane, double const value) {
+			plane.rowRange(0, top).setTo(cv::Scalar::all(value));
+			plane.rowRange(top + new_shape_h, height).setTo(cv::Scalar::all(value));
+			plane.rowRange(top, top + new_shape_h).colRange(0, left).setTo(cv::Scalar::all(value));
+			plane.rowRange(top, top + new_shape_h).colRange(left + new_shape_w, width).setTo(cv::Scalar::all(value));
+		};
+
+		if constexpr (output == DownscalingOutput::bgr) {
+			fill(ret, 114.);
+		} else {
+			for (int c = 0; c < 3; ++c) fill(ret.rowRange(c * height, (c + 1) * height), 114. / 255.);
+		}
+	}
+
    public:
 	ImageDownscalingNode() = default;
 
@@ -26,6 +135,9 @@ class ImageDownscalingNode : public Processor<ImageData, ImageData> {
 	 * @return The scaled image.
 	 */
 	ImageData process(ImageData const& data) final {
+		static auto& stage = latency_stage("down");
+		TraceScope scope(stage, data.trace);
+
 		ImageData ret;
 		ret.source = data.source;
 		ret.timestamp = data.timestamp;
@@ -40,13 +152,35 @@ class ImageDownscalingNode : public Processor<ImageData, ImageData> {
 		float const padh = static_cast<float>(height - new_shape_h) / 2.f;
 
 		int const top = static_cast<int>(std::round(padh - 0.1));
-		int const bottom = static_cast<int>(std::round(padh + 0.1));
 		int const left = static_cast<int>(std::round(padw - 0.1));
-		int const right = static_cast<int>(std::round(padw + 0.1));
 
-		cv::resize(data.image, ret.image, cv::Size(new_shape_w, new_shape_h), 0, 0, cv::INTER_AREA);
-		cv::copyMakeBorder(ret.image, ret.image, top, bottom, left, right, cv::BORDER_CONSTANT, cv::Scalar(114.));
+		ret.image = acquire_buffer();
+		fill_border(ret.image, top, left, new_shape_h, new_shape_w);
+
+		auto const is_factor = [&](int const factor) { return data.image.rows == factor * new_shape_h && data.image.cols == factor * new_shape_w; };
+		if (is_factor(2)) {
+			downscaling::box_downscale<2, output>(data.image, ret.image, height, top, left, _row_sums);
+		} else if (is_factor(3)) {
+			downscaling::box_downscale<3, output>(data.image, ret.image, height, top, left, _row_sums);
+		} else if (is_factor(4)) {
+			downscaling::box_downscale<4, output>(data.image, ret.image, height, top, left, _row_sums);
+		} else {
+			cv::resize(data.image, _resized, cv::Size(new_shape_w, new_shape_h), 0, 0, cv::INTER_AREA);
+
+			if constexpr (output == DownscalingOutput::bgr) {
+				_resized.copyTo(ret.image(cv::Rect(left, top, new_shape_w, new_shape_h)));
+			} else {
+				for (int y = 0; y < new_shape_h; ++y) {
+					auto const* resized_row = _resized.ptr<std::uint8_t>(y);
+					float* planes[3] = {ret.image.ptr<float>(top + y) + left, ret.image.ptr<float>(height + top + y) + left, ret.image.ptr<float>(2 * height + top + y) + left};
+					for (int x = 0; x < new_shape_w; ++x) {
+						for (int c = 0; c < 3; ++c) planes[c][x] = static_cast<float>(resized_row[x * 3 + c]) * (1.f / 255.f);
+					}
+				}
+			}
+		}
 
+		ret.trace = scope.finish(ret.timestamp);
 		return ret;
 	}
-};
\ No newline at end of file
+};
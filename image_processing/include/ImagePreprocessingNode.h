@@ -1,18 +1,51 @@
 #pragma once
 
+#include <array>
 #include <map>
+#include <memory>
 #include <opencv2/core/mat.hpp>
 #include <opencv2/opencv.hpp>
 #include <string>
 #include <vector>
 
+#include "BoundedEdgeNode.h"
 #include "ImageData.h"
 #include "ImageDataRaw.h"
 #include "Processor.h"
 
+/**
+ * @brief Describes the resolution of the images the raw bayer images are converted to.
+ */
+enum class PreprocessingResolution {
+	full,    ///< Demosaicing with cv::demosaicing, the image keeps the size of the raw image.
+	half,    ///< Every 2x2 bayer cell becomes one pixel.
+	quarter  ///< Every 4x4 block of bayer cells becomes one pixel.
+};
+
+/**
+ * @brief Returns the offsets of blue, green 1, green 2 and red within a 2x2 bayer cell, see the bayer pattern naming of OpenCV.
+ *
+ * @param code One of the bayer to BGR conversion codes.
+ * @param raw_width The width of the raw image, i.e. the offset from one row to the next.
+ */
+std::array<int, 4> bayer_channel_offsets(cv::ColorConversionCodes code, int raw_width);
+
 /**
  * @class ImagePreprocessingNode
  * @brief This class converts raw image data.
+ *
+ * For the detection branch, the full demosaicing is a waste because the image is downscaled to the size of the detector right afterward.
+ * With PreprocessingResolution::half or PreprocessingResolution::quarter, the BGR image is binned straight from the bayer cells in one pass over the raw image, without interpolation.
+ * The binned image has the aspect ratio of the raw image, so the letterbox geometry is the same and YoloNode keeps the full camera size to get the detections in full frame coordinates.
+ * If consumers such as StreamingImageNode or ImageSavingNode need the full resolution as well, the binning node also hands on the demosaiced image through full_resolution().
+ * Both images are then made in the same pass: the raw image is demosaiced in bands of rows, which are binned while they are still in the cache.
+ * @code
+ * ImagePreprocessingNode pre(configs, PreprocessingResolution::half, 1);
+ * pre.synchronously_connect(down);
+ * pre.full_resolution().synchronously_connect(stream);
+ * auto pre_thread = pre();
+ * auto full_resolution_thread = pre.full_resolution()();
+ * @endcode
  */
 class ImagePreprocessingNode : public Processor<ImageDataRaw, ImageData> {
    public:
@@ -24,9 +57,21 @@ class ImagePreprocessingNode : public Processor<ImageDataRaw, ImageData> {
 
    private:
 	std::map<std::string, HeightWidthConversionConfig> height_width_conversion_config;
+	PreprocessingResolution _resolution;
+	std::unique_ptr<BoundedEdgeNode<ImageData>> _full_resolution;
 
    public:
-	explicit ImagePreprocessingNode(std::map<std::string, HeightWidthConversionConfig>&& height_width_conversion);
+	/**
+	 * @param height_width_conversion A map that maps the names of the cameras to the size and bayer pattern of their raw images.
+	 * @param resolution The resolution of the converted images.
+	 * @param full_resolution_capacity The number of full resolution images queued for full_resolution(), 0 if a binning node does not hand them on.
+	 */
+	explicit ImagePreprocessingNode(std::map<std::string, HeightWidthConversionConfig>&& height_width_conversion, PreprocessingResolution resolution = PreprocessingResolution::full, std::size_t full_resolution_capacity = 0);
+
+	/**
+	 * @brief The full resolution images of a binning node. The edge drops the oldest image if its consumers fall behind and runs in its own thread.
+	 */
+	BoundedEdgeNode<ImageData>& full_resolution();
 
    private:
 	ImageData process(ImageDataRaw const& data) final;
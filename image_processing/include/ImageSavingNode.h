@@ -3,13 +3,25 @@
 #include <chrono>
 #include <filesystem>
 #include <map>
+#include <opencv2/opencv.hpp>
 
+#include "AsyncWriter.h"
 #include "ImageData.h"
 #include "Runner.h"
 
 /**
- * @class ImagePreprocessingNode
- * @brief This class saves image data to files.
+ * @brief Configures the JPEG encoding of ImageSavingNode.
+ */
+struct JpegConfig {
+	int quality = 95;                                            // 0 to 100
+	int sampling_factor = cv::IMWRITE_JPEG_SAMPLING_FACTOR_420;  // chroma subsampling, one of cv::ImwriteJPEGSamplingFactorParams
+};
+
+/**
+ * @class ImageSavingNode
+ * @brief This class saves image data to JPEG files.
+ *
+ * The images are encoded and written asynchronously in a pool of threads, so a slow disk drops frames instead of blocking the node and through it the cameras.
  */
 class ImageSavingNode : public Runner<ImageData> {
    public:
@@ -17,10 +29,19 @@ class ImageSavingNode : public Runner<ImageData> {
 		std::filesystem::path folder;
 	};
 
-	explicit ImageSavingNode(std::map<std::string, FolderConfig>&& config);
+	/**
+	 * @param config A map that maps the names of the cameras to the folders their images are saved to.
+	 * @param writer_config The queue and the threads of the writer.
+	 * @param jpeg_config The quality and the chroma subsampling of the JPEG files.
+	 */
+	explicit ImageSavingNode(std::map<std::string, FolderConfig>&& config, AsyncWriterConfig const& writer_config = {}, JpegConfig const& jpeg_config = {});
+
+	[[nodiscard]] WriterStatistics const& statistics() const { return _writer.statistics(); }
+	void print_statistics() const { _writer.print_statistics(); }
 
    private:
 	void run(ImageData const& data) final;
 
 	std::map<std::string, FolderConfig> _camera_name_folder_map;
-};
\ No newline at end of file
+	AsyncWriter<ImageData> _writer;
+};
@@ -1,6 +1,8 @@
 #pragma once
 
+#include <map>
 #include <opencv2/opencv.hpp>
+#include <string>
 
 #include "ImageData.h"
 #include "Processor.h"
@@ -8,6 +10,9 @@
 /**
  * @class ImageUndistortionNode
  * @brief This class undistorts an image.
+ *
+ * The undistortion maps are converted once to the fixed-point representation of OpenCV (CV_16SC2 and CV_16UC1), which is less than half the size of the float maps and remaps faster.
+ * The output images are remapped in horizontal bands in parallel and reuse the buffer of the previous image of the camera once no other node holds it anymore.
  */
 class ImageUndistortionNode : public Processor<ImageData, ImageData> {
    public:
@@ -21,10 +26,16 @@ class ImageUndistortionNode : public Processor<ImageData, ImageData> {
 
    private:
 	std::map<std::string, UndistortionConfig> camera_matrix_distortion_values_new_camera_matrix_undistortion_maps_config;
+	std::map<std::string, cv::Mat> _outputs;  // last output image per camera
+	int _bands;
 
    public:
-	explicit ImageUndistortionNode(std::map<std::string, UndistortionConfig>&& camera_matrix_distortion_values_new_camera_matrix_undistortion_maps);
+	/**
+	 * @param camera_matrix_distortion_values_new_camera_matrix_undistortion_maps The undistortion config per camera, the maps may be CV_32FC1 or already fixed-point.
+	 * @param bands The number of bands the image is remapped in parallel, 0 uses the number of threads of OpenCV.
+	 */
+	explicit ImageUndistortionNode(std::map<std::string, UndistortionConfig>&& camera_matrix_distortion_values_new_camera_matrix_undistortion_maps, int bands = 0);
 
    private:
 	ImageData process(ImageData const& data) final;
-};
\ No newline at end of file
+};
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <opencv2/opencv.hpp>
+#include <string>
+
+#include "ImageData.h"
+#include "Processor.h"
+
+/**
+ * @brief Configures when MotionGateNode lets an image pass to the detector.
+ */
+struct MotionGateConfig {
+	float pixel_threshold = 6.f;                                                  // gray levels out of 255 a pixel has to change to count as changed
+	double changed_fraction = 0.005;                                              // fraction of the pixels of a tile that have to change for the tile to count as changed
+	int tile_size = 32;                                                           // edge length of the tiles in pixels of the image, a multiple of the subsampling
+	int subsampling = 2;                                                          // the gray image is averaged over subsampling x subsampling blocks before it is compared
+	std::chrono::nanoseconds max_skip_interval = std::chrono::milliseconds(300);  // the detector runs at least this often, must be shorter than the max age of ImageTrackerNode
+};
+
+/**
+ * @brief Counters of a MotionGateNode. They can be read from any thread while the node is in use.
+ */
+struct MotionGateStatistics {
+	std::atomic<std::uint64_t> frames = 0;   ///< Number of analyzed images.
+	std::atomic<std::uint64_t> skipped = 0;  ///< Number of images on which the detector is skipped.
+	std::atomic<std::uint64_t> forced = 0;   ///< Number of images that are detected without motion because the max skip interval elapsed.
+	std::atomic<std::uint64_t> tiles = 0;    ///< Number of changed tiles of all images.
+};
+
+/**
+ * @class MotionGateNode
+ * @brief Tags the downscaled images with the regions that changed since the last detection of their camera, so that the detector can skip static frames.
+ *
+ * Every image is reduced to a small gray image that is compared tile by tile to the gray image of the last image of the same camera that was detected.
+ * Comparing to the last detected image instead of the previous image also catches objects that move less than the threshold per frame.
+ * If no tile changed, the image is tagged with ImageData::skip_detection, YoloNode then outputs empty coasting detections on which ImageTrackerNode only predicts.
+ * The node should run directly in front of the detector, behind any queue that drops images, so that every image it lets pass is actually detected.
+ */
+class MotionGateNode : public Processor<ImageData, ImageData> {
+	struct Reference {
+		cv::Mat gray;             // CV_32FC1 gray image of the last detected image
+		std::uint64_t timestamp;  // timestamp of the last detected image
+	};
+
+	MotionGateConfig _config;
+	std::map<std::string, Reference> _references;
+	cv::Mat _gray;
+	MotionGateStatistics _statistics;
+
+	/**
+	 * @brief Averages the gray values of the image into _gray.
+	 *
+	 * @param image A CV_8UC3 BGR image or a CV_32FC1 image in the planar layout of DownscalingOutput::chw_float.
+	 * @return The size of the image, i.e. one third of the rows of the planar layout.
+	 */
+	cv::Size make_gray(cv::Mat const& image);
+
+   public:
+	/**
+	 * @param config The thresholds, the tile size and the max skip interval.
+	 */
+	explicit MotionGateNode(MotionGateConfig const& config = {});
+
+	/**
+	 * @brief Compares the image to the last detected image of its camera.
+	 *
+	 * @param data The downscaled image.
+	 * @return The same image tagged with the changed tiles and whether the detector can skip it.
+	 */
+	ImageData process(ImageData const& data) final;
+
+	[[nodiscard]] MotionGateStatistics const& statistics() const { return _statistics; }
+
+	void print_statistics() const;
+};
@@ -4,12 +4,15 @@
 #include <filesystem>
 #include <map>
 
+#include "AsyncWriter.h"
 #include "ImageDataRaw.h"
 #include "Runner.h"
 
 /**
- * @class ImagePreprocessingNode
+ * @class RawImageSavingNode
  * @brief This class saves raw image data to files.
+ *
+ * The files are written asynchronously in a pool of threads, so a slow disk drops frames instead of blocking the node and through it the cameras.
  */
 class RawImageSavingNode : public Runner<ImageDataRaw> {
    public:
@@ -17,10 +20,18 @@ class RawImageSavingNode : public Runner<ImageDataRaw> {
 		std::filesystem::path folder;
 	};
 
-	explicit RawImageSavingNode(std::map<std::string, FolderConfig>&& config);
+	/**
+	 * @param config A map that maps the names of the cameras to the folders their raw images are saved to.
+	 * @param writer_config The queue and the threads of the writer.
+	 */
+	explicit RawImageSavingNode(std::map<std::string, FolderConfig>&& config, AsyncWriterConfig const& writer_config = {});
+
+	[[nodiscard]] WriterStatistics const& statistics() const { return _writer.statistics(); }
+	void print_statistics() const { _writer.print_statistics(); }
 
    private:
 	void run(ImageDataRaw const& data) final;
 
 	std::map<std::string, FolderConfig> _camera_name_folder_map;
-};
\ No newline at end of file
+	AsyncWriter<ImageDataRaw> _writer;
+};
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+
+#include "ImageDataRaw.h"
+#include "RawRecording.h"
+#include "Runner.h"
+
+/**
+ * @class RawRecordingSavingNode
+ * @brief This class saves raw image data of all cameras into one segmented recording instead of one file per frame.
+ *
+ * The recording can be replayed with RawRecordingCamerasSimulatorNode.
+ */
+class RawRecordingSavingNode : public Runner<ImageDataRaw> {
+   public:
+	/**
+	 * @param folder The folder of the recording.
+	 * @param segment_size The size segment files are preallocated with.
+	 */
+	explicit RawRecordingSavingNode(std::filesystem::path folder, std::uint64_t segment_size = std::uint64_t{1} << 30);
+
+   private:
+	void run(ImageDataRaw const& data) final;
+
+	RawRecordingWriter _writer;
+};
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <Eigen/Eigen>
+#include <map>
+#include <opencv2/opencv.hpp>
+#include <string>
+#include <vector>
+
+#include "ImageData.h"
+#include "Processor.h"
+
+/**
+ * @brief Describes the geometry of a camera from which the region that is relevant for the detection is derived.
+ */
+struct RegionOfInterestConfig {
+	Eigen::Matrix<double, 3, 4> projection_matrix;      // from the ground plane coordinate system into the image, e.g. config::projection_matrix_s110_base_north_into_s110_n_cam_8
+	int height;                                         // height of the image
+	int width;                                          // width of the image
+	double max_distance = 250.;                         // in m, the ground farther away from the camera is not relevant
+	double max_object_height = 4.5;                     // in m, objects on the relevant ground reach up to this height
+	std::vector<std::vector<cv::Point>> polygons = {};  // image regions that are kept, e.g. the road, empty keeps the full width
+};
+
+/**
+ * @brief The part of the image that is handed to the detector.
+ */
+struct RegionOfInterest {
+	cv::Rect crop;  // in full frame coordinates
+	cv::Mat mask;   // CV_8UC1 of the size of the crop, pixels that are 0 are grayed out, empty if the whole crop is kept
+};
+
+/**
+ * @brief Derives the region of interest of a camera from its field of view.
+ *
+ * The rows above the highest point at which an object of the maximum height standing on the relevant ground can appear show the sky or the far distance and are cropped away.
+ * If polygons are given, the crop is further reduced to their bounding box and the pixels outside of them are masked.
+ *
+ * @param config The geometry of the camera and the optional polygons.
+ * @return The region of interest.
+ */
+RegionOfInterest make_region_of_interest(RegionOfInterestConfig const& config);
+
+/**
+ * @class RegionOfInterestNode
+ * @brief Crops the images to the region of interest of their camera before they are letterboxed for the detector.
+ *
+ * Without a mask the crop is a view into the original image, so nothing is copied.
+ * The detections of the cropped images are in crop coordinates, YoloNode maps them back to full frame coordinates with the offsets of the crop.
+ */
+class RegionOfInterestNode : public Processor<ImageData, ImageData> {
+	std::map<std::string, RegionOfInterest> _regions;
+
+   public:
+	/**
+	 * @param regions A map that maps the names of the cameras to their region of interest, images of other cameras pass unchanged.
+	 */
+	explicit RegionOfInterestNode(std::map<std::string, RegionOfInterest> regions);
+
+	/**
+	 * @brief Crops and masks the image.
+	 *
+	 * @param data The full frame image.
+	 * @return The image of the region of interest.
+	 */
+	ImageData process(ImageData const& data) final;
+};
@@ -0,0 +1,29 @@
+#include "AsyncWriter.h"
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+
+bool write_file(std::filesystem::path const& path, std::uint8_t const* data, std::size_t size) {
+	int const fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+	if (fd < 0) {
+		common::println_warn_loc("Could not open ", path, ": ", std::strerror(errno), '!');
+		return false;
+	}
+
+	while (size) {
+		ssize_t const written = ::write(fd, data, size);
+		if (written < 0) {
+			if (errno == EINTR) continue;
+			common::println_warn_loc("Could not write ", path, ": ", std::strerror(errno), '!');
+			::close(fd);
+			return false;
+		}
+		data += written;
+		size -= static_cast<std::size_t>(written);
+	}
+
+	return ::close(fd) == 0;
+}
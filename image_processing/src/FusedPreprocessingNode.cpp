@@ -0,0 +1,164 @@
+#include "FusedPreprocessingNode.h"
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include <tuple>
+
+#include "ImagePreprocessingNode.h"
+#include "common_output.h"
+
+/**
+ * @brief Samples a CV_32FC1 map bilinearly, clamped to its border.
+ */
+static float sample(cv::Mat const& map, float const x, float const y) {
+	float const cx = std::clamp(x, 0.f, static_cast<float>(map.cols - 1));
+	float const cy = std::clamp(y, 0.f, static_cast<float>(map.rows - 1));
+	int const x0 = std::min(static_cast<int>(cx), map.cols - 2);
+	int const y0 = std::min(static_cast<int>(cy), map.rows - 2);
+	float const fx = cx - static_cast<float>(x0);
+	float const fy = cy - static_cast<float>(y0);
+
+	auto const* row0 = map.ptr<float>(y0);
+	auto const* row1 = map.ptr<float>(y0 + 1);
+	return (row0[x0] * (1.f - fx) + row0[x0 + 1] * fx) * (1.f - fy) + (row1[x0] * (1.f - fx) + row1[x0 + 1] * fx) * fy;
+}
+
+static constexpr int max_taps = 8;
+
+/**
+ * @brief Computes the weights of the samples of one bayer channel along one direction for the footprint of an output pixel.
+ *
+ * The footprint is averaged over the pixels it covers, weighted by the covered fraction like cv::INTER_AREA does.
+ * The channel at a pixel is interpolated linearly between its samples 2 pixels apart like the bilinear demosaicing does, so the weights keep the true position of the samples.
+ * Pixels outside the image are replaced by the nearest pixel inside.
+ *
+ * @param center The center of the footprint in pixels, the pixel i spans [i - 0.5, i + 0.5].
+ * @param half_width Half the width of the footprint in pixels.
+ * @param parity 0 if the channel is sampled in the even pixels, 1 if in the odd pixels.
+ * @param size The number of pixels of the raw image in this direction.
+ * @param taps The number of weights.
+ * @param weights The weights of the taps samples starting at the returned pixel, in 1/1024.
+ * @return The pixel of the first sample.
+ */
+static int footprint_weights(float const center, float const half_width, int const parity, int const size, int const taps, std::uint16_t* const weights) {
+	int const samples = size / 2;
+	float const begin = center - half_width;
+	float const end = center + half_width;
+	int const first_pixel = static_cast<int>(std::floor(begin + 0.5f));
+	int const first = std::clamp((std::clamp(first_pixel, 0, size - 1) - parity) / 2, 0, samples - taps);
+
+	std::array<double, max_taps> sums{};
+	for (int i = first_pixel; static_cast<float>(i) - 0.5f < end; ++i) {
+		double const coverage = std::min(end, static_cast<float>(i) + 0.5f) - std::max(begin, static_cast<float>(i) - 0.5f);
+		if (coverage <= 0.) continue;
+
+		double const position = static_cast<double>(std::clamp(i, 0, size - 1) - parity) / 2.;
+		int const sample = static_cast<int>(std::floor(position));
+		double const fraction = position - static_cast<double>(sample);
+		sums[std::clamp(std::clamp(sample, 0, samples - 1) - first, 0, taps - 1)] += coverage * (1. - fraction);
+		sums[std::clamp(std::clamp(sample + 1, 0, samples - 1) - first, 0, taps - 1)] += coverage * fraction;
+	}
+
+	// the rounded weights must add up to exactly 1024, so the largest one takes the rounding error
+	double const total = std::accumulate(sums.begin(), sums.begin() + taps, 0.);
+	int sum = 0;
+	for (int k = 0; k < taps; ++k) sum += weights[k] = static_cast<std::uint16_t>(std::lround(sums[k] / total * 1024.));
+	weights[std::max_element(sums.begin(), sums.begin() + taps) - sums.begin()] += 1024 - sum;
+
+	return 2 * first + parity;
+}
+
+FusedPreprocessingLut make_fused_preprocessing_lut(FusedPreprocessingConfig const& config, int const height, int const width) {
+	if (config.height < 4 || config.width < 4 || config.height % 2 || config.width % 2) common::println_critical_loc("The raw image must consist of complete bayer quads!");
+	bool const undistort = !config.undistortion_map1.empty();
+	if (undistort && (config.undistortion_map1.type() != CV_32FC1 || config.undistortion_map2.type() != CV_32FC1 || config.undistortion_map1.size() != cv::Size(config.width, config.height) ||
+	                     config.undistortion_map2.size() != cv::Size(config.width, config.height)))
+		common::println_critical_loc("The undistortion maps must be CV_32FC1 maps of the size of the raw image!");
+
+	// same letterbox geometry as ImageDownscalingNode
+	float const resize_scale = std::min(static_cast<float>(height) / static_cast<float>(config.height), static_cast<float>(width) / static_cast<float>(config.width));
+	int const new_shape_w = static_cast<int>(std::round(static_cast<float>(config.width) * resize_scale));
+	int const new_shape_h = static_cast<int>(std::round(static_cast<float>(config.height) * resize_scale));
+	int const top = static_cast<int>(std::round(static_cast<float>(height - new_shape_h) / 2.f - 0.1));
+	int const left = static_cast<int>(std::round(static_cast<float>(width - new_shape_w) / 2.f - 0.1));
+
+	// the footprint of an output pixel in pixels of the raw image, the undistortion hardly changes the scale locally, so it is not taken into account
+	float const half_width = static_cast<float>(config.width) / static_cast<float>(new_shape_w) / 2.f;
+	float const half_height = static_cast<float>(config.height) / static_cast<float>(new_shape_h) / 2.f;
+
+	// the footprint covers 2 half_width + 1 pixels, the interpolation adds one pixel on each side, and every second of these pixels is a sample
+	int const taps = static_cast<int>(std::ceil(2.f * std::max(half_width, half_height))) / 2 + 2;
+	if (taps > max_taps || 2 * taps > std::min(config.width, config.height)) common::println_critical_loc("The output image is too small for the raw image!");
+
+	auto const offsets = bayer_channel_offsets(config.color_conversion_code, config.width);
+	FusedPreprocessingLut lut{config.height, config.width, taps, {}, {}, {}};
+	std::ranges::transform(offsets, lut.channels.begin(), [&config](int const offset) { return cv::Point(offset % config.width, offset / config.width); });
+	lut.entries.reserve(static_cast<std::size_t>(height) * width);
+	lut.weights.resize(static_cast<std::size_t>(height) * width * 4 * taps);
+
+	std::uint16_t* weights = lut.weights.data();
+	for (int y = 0; y < height; ++y) {
+		for (int x = 0; x < width; ++x, weights += 4 * taps) {
+			if (y < top || y >= top + new_shape_h || x < left || x >= left + new_shape_w) {
+				lut.entries.push_back({{-1, -1}, {-1, -1}});
+				continue;
+			}
+
+			// pixel centers of the letterboxed image in the undistorted full resolution image
+			float u = (static_cast<float>(x - left) + 0.5f) * static_cast<float>(config.width) / static_cast<float>(new_shape_w) - 0.5f;
+			float v = (static_cast<float>(y - top) + 0.5f) * static_cast<float>(config.height) / static_cast<float>(new_shape_h) - 0.5f;
+
+			// the undistortion maps tell where the pixels of the undistorted image are in the distorted raw image
+			if (undistort) std::tie(u, v) = std::pair{sample(config.undistortion_map1, u, v), sample(config.undistortion_map2, u, v)};
+
+			FusedPreprocessingLut::Entry entry;
+			for (int parity = 0; parity < 2; ++parity) {
+				entry.cols[parity] = footprint_weights(u, half_width, parity, config.width, taps, weights + parity * taps);
+				entry.rows[parity] = footprint_weights(v, half_height, parity, config.height, taps, weights + (2 + parity) * taps);
+			}
+			lut.entries.push_back(entry);
+		}
+	}
+
+	return lut;
+}
+
+void apply_fused_preprocessing_lut(FusedPreprocessingLut const& lut, std::uint8_t const* const raw, cv::Mat& image) {
+	if (image.type() != CV_8UC3 || image.total() != lut.entries.size()) common::println_critical_loc("The output image does not match the lookup table!");
+
+	auto const [blue, green1, green2, red] = lut.channels;
+	int const taps = lut.taps;
+	std::ptrdiff_t const down = 2 * static_cast<std::ptrdiff_t>(lut.raw_width);
+
+	auto const* entry = lut.entries.data();
+	auto const* weights = lut.weights.data();
+	for (int y = 0; y < image.rows; ++y) {
+		auto* out = image.ptr<std::uint8_t>(y);
+		for (int x = 0; x < image.cols; ++x, ++entry, weights += 4 * taps, out += 3) {
+			if (entry->cols[0] < 0) {
+				out[0] = out[1] = out[2] = 114;
+				continue;
+			}
+
+			// sum of the samples of the channel weighted in both directions, in 1/1024^2
+			auto const average = [&](cv::Point const channel) {
+				auto const* wx = weights + channel.x * taps;
+				auto const* wy = weights + (2 + channel.y) * taps;
+				auto const* row = raw + static_cast<std::ptrdiff_t>(entry->rows[channel.y]) * lut.raw_width + entry->cols[channel.x];
+
+				std::uint32_t sum = 0;
+				for (int j = 0; j < taps; ++j, row += down) {
+					std::uint32_t row_sum = 0;
+					for (int i = 0; i < taps; ++i) row_sum += wx[i] * row[2 * i];
+					sum += wy[j] * row_sum;
+				}
+				return sum;
+			};
+
+			out[0] = static_cast<std::uint8_t>((average(blue) + (1u << 19)) >> 20);
+			out[1] = static_cast<std::uint8_t>((average(green1) + average(green2) + (1u << 20)) >> 21);
+			out[2] = static_cast<std::uint8_t>((average(red) + (1u << 19)) >> 20);
+		}
+	}
+}
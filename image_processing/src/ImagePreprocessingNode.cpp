@@ -1,21 +1,148 @@
 #include "ImagePreprocessingNode.h"
 
-ImagePreprocessingNode::ImagePreprocessingNode(std::map<std::string, HeightWidthConversionConfig>&& height_width_conversion) : height_width_conversion_config(height_width_conversion) {}
+#include <algorithm>
+#include <cstdint>
+
+#include "LatencyTracer.h"
+#include "common_output.h"
+
+std::array<int, 4> bayer_channel_offsets(cv::ColorConversionCodes const code, int const raw_width) {
+	auto const at = [raw_width](int const x, int const y) { return y * raw_width + x; };
+
+	switch (code) {
+		case cv::COLOR_BayerBG2BGR: return {at(1, 1), at(1, 0), at(0, 1), at(0, 0)};
+		case cv::COLOR_BayerRG2BGR: return {at(0, 0), at(1, 0), at(0, 1), at(1, 1)};
+		case cv::COLOR_BayerGB2BGR: return {at(0, 1), at(0, 0), at(1, 1), at(1, 0)};
+		case cv::COLOR_BayerGR2BGR: return {at(1, 0), at(0, 0), at(1, 1), at(0, 1)};
+		default: common::println_critical_loc("Only the bayer to bgr conversions are supported!");
+	}
+}
+
+/**
+ * @brief Averages cells x cells bayer cells into one BGR pixel.
+ *
+ * The number of cells is known at compile time, so the loops over the cells are unrolled.
+ * The channels are read with the offsets of the bayer pattern and written interleaved, so the loop over the row stays scalar.
+ */
+template <int cells>
+static void bin_bayer(std::uint8_t const* const raw, int const raw_width, std::array<int, 4> const& offsets, cv::Mat& image) {
+	constexpr int color_shift = 2 * (cells / 2);  // log2(cells * cells) for 1 and 2 cells
+	auto const [blue, green1, green2, red] = offsets;
+
+	for (int y = 0; y < image.rows; ++y) {
+		std::uint8_t const* const row = raw + static_cast<std::size_t>(y) * 2 * cells * raw_width;
+		auto* out = image.ptr<std::uint8_t>(y);
+		for (int x = 0; x < image.cols; ++x) {
+			unsigned b = 0, g = 0, r = 0;
+			for (int cy = 0; cy < cells; ++cy) {
+				for (int cx = 0; cx < cells; ++cx) {
+					std::uint8_t const* const cell = row + static_cast<std::size_t>(cy) * 2 * raw_width + 2 * (x * cells + cx);
+					b += cell[blue];
+					g += cell[green1] + cell[green2];
+					r += cell[red];
+				}
+			}
+			out[3 * x] = static_cast<std::uint8_t>((b + (1u << color_shift >> 1)) >> color_shift);
+			out[3 * x + 1] = static_cast<std::uint8_t>((g + (1u << color_shift)) >> (color_shift + 1));
+			out[3 * x + 2] = static_cast<std::uint8_t>((r + (1u << color_shift >> 1)) >> color_shift);
+		}
+	}
+}
+
+/**
+ * @brief Demosaics the raw image into full and bins its cells into binned in the same pass over the raw image.
+ *
+ * The raw image is demosaiced in bands of rows, every band is binned right after it was demosaiced, while its raw rows are still in the cache.
+ * cv::demosaicing treats the first and the last row of a band as the border of the image, so these rows are demosaiced again with their neighbors afterward.
+ */
+template <int cells>
+static void demosaic_and_bin(cv::Mat const& bayer, cv::ColorConversionCodes const code, std::array<int, 4> const& offsets, cv::Mat& full, cv::Mat& binned) {
+	constexpr int band_rows = 32 * cells;  // a multiple of the raw rows of a binned pixel and of the rows of a bayer cell
+
+	cv::Mat seam;
+	for (int y = 0; y < bayer.rows; y += band_rows) {
+		int const end = std::min(y + band_rows, bayer.rows);
+		cv::Mat band = full.rowRange(y, end);
+		cv::demosaicing(bayer.rowRange(y, end), band, code);
+
+		if (y > 0) {
+			cv::demosaicing(bayer.rowRange(y - 2, std::min(y + 2, bayer.rows)), seam, code);
+			seam.rowRange(1, 3).copyTo(full.rowRange(y - 1, y + 1));
+		}
+
+		cv::Mat binned_band = binned.rowRange(y / (2 * cells), end / (2 * cells));
+		bin_bayer<cells>(bayer.ptr<std::uint8_t>(y), bayer.cols, offsets, binned_band);
+	}
+}
+
+ImagePreprocessingNode::ImagePreprocessingNode(std::map<std::string, HeightWidthConversionConfig>&& height_width_conversion, PreprocessingResolution const resolution, std::size_t const full_resolution_capacity)
+    : height_width_conversion_config(height_width_conversion),
+      _resolution(resolution),
+      _full_resolution(full_resolution_capacity ? std::make_unique<BoundedEdgeNode<ImageData>>("pre->full resolution", full_resolution_capacity, OverflowPolicy::drop_oldest) : nullptr) {
+	if (_full_resolution && resolution == PreprocessingResolution::full) common::println_critical_loc("Only a binning node hands on the full resolution images separately!");
+
+	int const divisor = resolution == PreprocessingResolution::quarter ? 4 : 2;
+	for (auto const& [camera, config] : height_width_conversion_config) {
+		if (resolution != PreprocessingResolution::full && (config.height % divisor || config.width % divisor))
+			common::println_critical_loc("The raw image of ", camera, " cannot be binned because its size is not a multiple of ", divisor, "!");
+	}
+}
 
 /**
- * @brief Performs demosaicing of the input raw bayer image.
+ * @brief Performs demosaicing or binning of the input raw bayer image.
  *
  * @param data The raw image to be converted.
  * @return The converted image data.
  */
 ImageData ImagePreprocessingNode::process(const ImageDataRaw& data) {
-	// const cast is allowed here because vector is not changed
-	cv::Mat const bayer_image(height_width_conversion_config.at(data.source).height, height_width_conversion_config.at(data.source).width, CV_8UC1, const_cast<std::uint8_t*>(data.image_raw.data()));
+	static auto& stage = latency_stage("pre");
+	TraceScope scope(stage);
+
+	auto const& config = height_width_conversion_config.at(data.source);
 
 	ImageData ret;
 	ret.timestamp = data.timestamp;
 	ret.source = data.source;
-	cv::demosaicing(bayer_image, ret.image, height_width_conversion_config.at(data.source).color_conversion_code);
 
+	switch (_resolution) {
+		case PreprocessingResolution::full: {
+			// const cast is allowed here because the raw buffer is only read, it may be a grab buffer of the camera or a mapped recording
+			cv::Mat const bayer_image(config.height, config.width, CV_8UC1, const_cast<std::uint8_t*>(data.image_raw.data()));
+			cv::demosaicing(bayer_image, ret.image, config.color_conversion_code);
+			break;
+		}
+		case PreprocessingResolution::half:
+		case PreprocessingResolution::quarter: {
+			int const cells = _resolution == PreprocessingResolution::half ? 1 : 2;
+			auto const offsets = bayer_channel_offsets(config.color_conversion_code, config.width);
+			ret.image.create(config.height / (2 * cells), config.width / (2 * cells), CV_8UC3);
+
+			if (!_full_resolution) {
+				if (cells == 1)
+					bin_bayer<1>(data.image_raw.data(), config.width, offsets, ret.image);
+				else
+					bin_bayer<2>(data.image_raw.data(), config.width, offsets, ret.image);
+				break;
+			}
+
+			cv::Mat const bayer_image(config.height, config.width, CV_8UC1, const_cast<std::uint8_t*>(data.image_raw.data()));
+			cv::Mat full(config.height, config.width, CV_8UC3);
+			if (cells == 1)
+				demosaic_and_bin<1>(bayer_image, config.color_conversion_code, offsets, full, ret.image);
+			else
+				demosaic_and_bin<2>(bayer_image, config.color_conversion_code, offsets, full, ret.image);
+
+			ret.trace = scope.finish(ret.timestamp);
+			_full_resolution->enqueue(ImageData{full, ret.timestamp, ret.source, ret.trace});
+			return ret;
+		}
+	}
+
+	ret.trace = scope.finish(ret.timestamp);
 	return ret;
 }
+
+BoundedEdgeNode<ImageData>& ImagePreprocessingNode::full_resolution() {
+	if (!_full_resolution) common::println_critical_loc("The node was constructed without a full resolution capacity!");
+	return *_full_resolution;
+}
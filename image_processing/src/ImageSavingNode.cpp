@@ -1,20 +1,27 @@
 #include "ImageSavingNode.h"
 
-#include <opencv2/opencv.hpp>
+#include <vector>
 
-ImageSavingNode::ImageSavingNode(std::map<std::string, FolderConfig>&& config) : _camera_name_folder_map(std::forward<decltype(config)>(config)) {
+ImageSavingNode::ImageSavingNode(std::map<std::string, FolderConfig>&& config, AsyncWriterConfig const& writer_config, JpegConfig const& jpeg_config)
+    : _camera_name_folder_map(std::forward<decltype(config)>(config)),
+      _writer("image saving", writer_config, [params = std::vector<int>{cv::IMWRITE_JPEG_QUALITY, jpeg_config.quality, cv::IMWRITE_JPEG_SAMPLING_FACTOR, jpeg_config.sampling_factor}](std::filesystem::path const& path, ImageData const& data) -> std::size_t {
+	      // every thread of the writer encodes into its own buffer, which keeps its capacity between the images
+	      thread_local std::vector<std::uint8_t> jpeg;
+	      if (!cv::imencode(".jpg", data.image, jpeg, params)) return 0;
+	      return write_file(path, jpeg.data(), jpeg.size()) ? jpeg.size() : 0;
+      }) {
 	for (auto const& [camera_name, folder_config] : _camera_name_folder_map) {
 		std::filesystem::create_directories(folder_config.folder);
 	}
 }
 
 /**
- * @brief Saves the incoming image data to the previous defined folder.
+ * @brief Hands the incoming image data to the writer, which saves it to the previous defined folder.
  *
  * @param data The image data to be saved.
  */
 void ImageSavingNode::run(const ImageData& data) {
-	cv::imwrite(
+	_writer.push(
 	    _camera_name_folder_map.at(data.source).folder / (std::to_string(std::chrono::time_point_cast<std::chrono::nanoseconds>(std::chrono::system_clock::now()).time_since_epoch().count()) + '_' + std::to_string(data.timestamp) + ".jpg"),
-	    data.image);
+	    data);
 }
@@ -1,23 +1,59 @@
 #include "ImageUndistortionNode.h"
 
-ImageUndistortionNode::ImageUndistortionNode(std::map<std::string, UndistortionConfig>&& camera_matrix_distortion_values_new_camera_matrix_undistortion_maps)
+#include <algorithm>
+
+#include "LatencyTracer.h"
+#include "common_output.h"
+
+ImageUndistortionNode::ImageUndistortionNode(std::map<std::string, UndistortionConfig>&& camera_matrix_distortion_values_new_camera_matrix_undistortion_maps, int const bands)
     : camera_matrix_distortion_values_new_camera_matrix_undistortion_maps_config(
-          std::forward<decltype(camera_matrix_distortion_values_new_camera_matrix_undistortion_maps_config)>(camera_matrix_distortion_values_new_camera_matrix_undistortion_maps)) {}
+          std::forward<decltype(camera_matrix_distortion_values_new_camera_matrix_undistortion_maps_config)>(camera_matrix_distortion_values_new_camera_matrix_undistortion_maps)),
+      _bands(bands > 0 ? bands : std::max(cv::getNumThreads(), 1)) {
+	for (auto& [camera, config] : camera_matrix_distortion_values_new_camera_matrix_undistortion_maps_config) {
+		if (config.undistortion_map1.type() == CV_16SC2) continue;
+		if (config.undistortion_map1.type() != CV_32FC1 || config.undistortion_map2.type() != CV_32FC1) common::println_critical_loc("The undistortion maps of ", camera, " must be CV_32FC1 or CV_16SC2 maps!");
+
+		// the float maps of the config are shared, so the fixed-point maps are new matrices
+		cv::Mat map1, map2;
+		cv::convertMaps(config.undistortion_map1, config.undistortion_map2, map1, map2, CV_16SC2);
+		config.undistortion_map1 = map1;
+		config.undistortion_map2 = map2;
+	}
+}
 
 /**
  * @brief Performs undistortion of the input image. See https://docs.opencv.org/4.x/d9/d0c/group__calib3d.html.
  *
+ * The input image is only read, so it is remapped without copying it first.
+ *
  * @param data The distorted image data.
  * @return The undistorted image data.
  */
 ImageData ImageUndistortionNode::process(ImageData const& data) {
-	cv::Mat distorted_image = data.image.clone();
+	static auto& stage = latency_stage("undist");
+	TraceScope scope(stage, data.trace);
+
+	auto const& config = camera_matrix_distortion_values_new_camera_matrix_undistortion_maps_config.at(data.source);
+
+	// the last output can be reused if the downstream nodes released it, otherwise they would see it change
+	cv::Mat& output = _outputs[data.source];
+	if (output.u && output.u->refcount > 1) output.release();
+	output.create(config.undistortion_map1.size(), data.image.type());
+
+	int const rows = output.rows;
+	cv::parallel_for_(cv::Range(0, _bands), [&](cv::Range const& range) {
+		for (int band = range.start; band < range.end; ++band) {
+			cv::Range const band_rows(rows * band / _bands, rows * (band + 1) / _bands);
+			cv::Mat band_output = output.rowRange(band_rows);
+			cv::remap(data.image, band_output, config.undistortion_map1.rowRange(band_rows), config.undistortion_map2.rowRange(band_rows), cv::INTER_LINEAR);
+		}
+	});
 
 	ImageData ret;
 	ret.timestamp = data.timestamp;
 	ret.source = data.source;
-	cv::remap(distorted_image, ret.image, camera_matrix_distortion_values_new_camera_matrix_undistortion_maps_config.at(data.source).undistortion_map1,
-	    camera_matrix_distortion_values_new_camera_matrix_undistortion_maps_config.at(data.source).undistortion_map2, cv::INTER_LINEAR);
+	ret.image = output;
 
+	ret.trace = scope.finish(ret.timestamp);
 	return ret;
-}
\ No newline at end of file
+}
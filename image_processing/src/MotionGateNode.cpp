@@ -0,0 +1,103 @@
+#include "MotionGateNode.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "LatencyTracer.h"
+#include "common_output.h"
+
+MotionGateNode::MotionGateNode(MotionGateConfig const& config) : _config(config) {
+	if (_config.subsampling < 1 || _config.tile_size < _config.subsampling || _config.tile_size % _config.subsampling) {
+		common::println_critical_loc("The tile size ", _config.tile_size, " must be a multiple of the subsampling ", _config.subsampling, '!');
+	}
+}
+
+cv::Size MotionGateNode::make_gray(cv::Mat const& image) {
+	bool const planar = image.type() == CV_32FC1;
+	if (!planar && image.type() != CV_8UC3) common::println_critical_loc("The motion gate needs a BGR image or the planar float layout of the downscaling!");
+
+	int const rows = planar ? image.rows / 3 : image.rows;
+	int const subsampling = _config.subsampling;
+	_gray.create(rows / subsampling, image.cols / subsampling, CV_32FC1);
+
+	int const cols = _gray.cols * subsampling;
+	float const normalization = (planar ? 255.f : 1.f) / static_cast<float>(subsampling * subsampling);
+	for (int y = 0; y < _gray.rows; ++y) {
+		float* gray_row = _gray.ptr<float>(y);
+		std::fill_n(gray_row, _gray.cols, 0.f);
+
+		for (int k = 0; k < subsampling; ++k) {
+			int const row = y * subsampling + k;
+			if (planar) {
+				float const* b = image.ptr<float>(row);
+				float const* g = image.ptr<float>(rows + row);
+				float const* r = image.ptr<float>(2 * rows + row);
+				for (int x = 0; x < cols; ++x) gray_row[x / subsampling] += 0.114f * b[x] + 0.587f * g[x] + 0.299f * r[x];
+			} else {
+				auto const* bgr = image.ptr<std::uint8_t>(row);
+				for (int x = 0; x < cols; ++x) gray_row[x / subsampling] += 0.114f * bgr[x * 3] + 0.587f * bgr[x * 3 + 1] + 0.299f * bgr[x * 3 + 2];
+			}
+		}
+
+		for (int x = 0; x < _gray.cols; ++x) gray_row[x] *= normalization;
+	}
+
+	return {image.cols, rows};
+}
+
+ImageData MotionGateNode::process(ImageData const& data) {
+	static auto& stage = latency_stage("motion");
+	TraceScope scope(stage, data.trace);
+
+	ImageData ret;
+	ret.image = data.image;
+	ret.timestamp = data.timestamp;
+	ret.source = data.source;
+
+	cv::Size const size = make_gray(data.image);
+	auto& reference = _references[data.source];
+
+	if (reference.gray.size() == _gray.size()) {
+		int const cells = _config.tile_size / _config.subsampling;
+		for (int tile_y = 0; tile_y < _gray.rows; tile_y += cells) {
+			for (int tile_x = 0; tile_x < _gray.cols; tile_x += cells) {
+				int const tile_h = std::min(cells, _gray.rows - tile_y);
+				int const tile_w = std::min(cells, _gray.cols - tile_x);
+
+				int changed = 0;
+				for (int y = tile_y; y < tile_y + tile_h; ++y) {
+					float const* gray_row = _gray.ptr<float>(y);
+					float const* reference_row = reference.gray.ptr<float>(y);
+					for (int x = tile_x; x < tile_x + tile_w; ++x) changed += std::abs(gray_row[x] - reference_row[x]) > _config.pixel_threshold;
+				}
+
+				if (changed > _config.changed_fraction * tile_h * tile_w) {
+					ret.motion.emplace_back(cv::Rect(tile_x * _config.subsampling, tile_y * _config.subsampling, tile_w * _config.subsampling, tile_h * _config.subsampling) & cv::Rect(cv::Point(), size));
+				}
+			}
+		}
+
+		// the first image of a camera, a size change or an out of order timestamp always runs the detector
+		bool const expired = data.timestamp < reference.timestamp || std::chrono::nanoseconds(data.timestamp - reference.timestamp) >= _config.max_skip_interval;
+		ret.skip_detection = !expired && ret.motion.empty();
+		if (expired && ret.motion.empty()) _statistics.forced.fetch_add(1, std::memory_order_relaxed);
+	}
+
+	_statistics.frames.fetch_add(1, std::memory_order_relaxed);
+	_statistics.tiles.fetch_add(ret.motion.size(), std::memory_order_relaxed);
+	if (ret.skip_detection) {
+		_statistics.skipped.fetch_add(1, std::memory_order_relaxed);
+	} else {
+		std::swap(reference.gray, _gray);
+		reference.timestamp = data.timestamp;
+	}
+
+	ret.trace = scope.finish(ret.timestamp);
+	return ret;
+}
+
+void MotionGateNode::print_statistics() const {
+	auto const frames = _statistics.frames.load();
+	common::println("motion gate: frames ", frames, ", skipped ", _statistics.skipped.load(), " (", frames ? 100. * _statistics.skipped.load() / frames : 0., " %), forced ", _statistics.forced.load(), ", changed tiles per frame ",
+	    frames ? static_cast<double>(_statistics.tiles.load()) / frames : 0.);
+}
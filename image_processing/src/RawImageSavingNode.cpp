@@ -1,21 +1,25 @@
 #include "RawImageSavingNode.h"
 
-#include <fstream>
+#include <vector>
 
-RawImageSavingNode::RawImageSavingNode(std::map<std::string, FolderConfig>&& config) : _camera_name_folder_map(std::forward<decltype(config)>(config)) {
+RawImageSavingNode::RawImageSavingNode(std::map<std::string, FolderConfig>&& config, AsyncWriterConfig const& writer_config)
+    : _camera_name_folder_map(std::forward<decltype(config)>(config)), _writer("raw image saving", writer_config, [](std::filesystem::path const& path, ImageDataRaw const& data) -> std::size_t {
+	      return write_file(path, data.image_raw.data(), data.image_raw.size()) ? data.image_raw.size() : 0;
+      }) {
 	for (auto const& [camera_name, folder_config] : _camera_name_folder_map) {
 		std::filesystem::create_directories(folder_config.folder);
 	}
 }
 
 /**
- * @brief Saves the incoming raw image data to the previous defined folder.
+ * @brief Hands the incoming raw image data to the writer, which saves it to the previous defined folder.
+ *
+ * The bytes are copied before they are queued, because the raw buffer may be a grab buffer of the camera, which must be given back quickly.
+ * If the writer drops the frame, the bytes are not copied at all.
  *
  * @param data The raw image data to be saved.
  */
 void RawImageSavingNode::run(const ImageDataRaw& data) {
-	std::ofstream raw_image(
-	    _camera_name_folder_map.at(data.source).folder / (std::to_string(std::chrono::time_point_cast<std::chrono::nanoseconds>(std::chrono::system_clock::now()).time_since_epoch().count()) + '_' + std::to_string(data.timestamp)));
-
-	raw_image.write(reinterpret_cast<const char*>(data.image_raw.data()), data.image_raw.size());
+	_writer.push_lazily(_camera_name_folder_map.at(data.source).folder / (std::to_string(std::chrono::time_point_cast<std::chrono::nanoseconds>(std::chrono::system_clock::now()).time_since_epoch().count()) + '_' + std::to_string(data.timestamp)),
+	    [&data] { return ImageDataRaw{std::vector<std::uint8_t>(data.image_raw.begin(), data.image_raw.end()), data.timestamp, data.source}; });
 }
@@ -0,0 +1,14 @@
+#include "RawRecordingSavingNode.h"
+
+#include <chrono>
+
+RawRecordingSavingNode::RawRecordingSavingNode(std::filesystem::path folder, std::uint64_t const segment_size) : _writer(std::move(folder), segment_size) {}
+
+/**
+ * @brief Appends the incoming raw image data to the recording.
+ *
+ * @param data The raw image data to be saved.
+ */
+void RawRecordingSavingNode::run(ImageDataRaw const& data) {
+	_writer.append(data.source, std::chrono::time_point_cast<std::chrono::nanoseconds>(std::chrono::system_clock::now()).time_since_epoch().count(), data.timestamp, data.image_raw);
+}
@@ -0,0 +1,67 @@
+#include "RegionOfInterestNode.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "LatencyTracer.h"
+#include "common_output.h"
+
+RegionOfInterest make_region_of_interest(RegionOfInterestConfig const& config) {
+	Eigen::Matrix<double, 3, 3> const KR_inv = config.projection_matrix.leftCols<3>().inverse();
+	Eigen::Vector3d const camera = -KR_inv * config.projection_matrix.col(3);
+
+	// per column, the first row from the top that shows relevant ground gives the highest row at which an object on that ground can appear
+	int top = config.height;
+	for (int const u : {0, config.width / 4, config.width / 2, 3 * config.width / 4, config.width - 1}) {
+		for (int v = 0; v < config.height; ++v) {
+			Eigen::Vector3d const ray = KR_inv * Eigen::Vector3d(u, v, 1.);
+			if (ray.z() > -1e-9) continue;  // the pixel shows the sky
+
+			Eigen::Vector3d const ground = camera - camera.z() / ray.z() * ray;
+			if ((ground - camera).head<2>().norm() > config.max_distance) continue;
+
+			Eigen::Vector3d const object_top = config.projection_matrix * Eigen::Vector4d(ground.x(), ground.y(), config.max_object_height, 1.);
+			if (object_top.z() > 0.) top = std::min(top, static_cast<int>(std::floor(object_top.y() / object_top.z())));
+			break;
+		}
+	}
+	if (top >= config.height) common::println_critical_loc("The camera does not see the ground plane within ", config.max_distance, " m!");
+	top = std::max(top, 0);
+
+	RegionOfInterest ret{cv::Rect(0, top, config.width, config.height - top), cv::Mat()};
+	if (config.polygons.empty()) return ret;
+
+	cv::Rect bounds;
+	for (auto const& polygon : config.polygons) bounds |= cv::boundingRect(polygon);
+	ret.crop &= bounds;
+	if (ret.crop.empty()) common::println_critical_loc("The polygons do not overlap with the ground in the field of view!");
+
+	ret.mask = cv::Mat::zeros(ret.crop.size(), CV_8UC1);
+	cv::fillPoly(ret.mask, config.polygons, cv::Scalar(255), cv::LINE_8, 0, -ret.crop.tl());
+	return ret;
+}
+
+RegionOfInterestNode::RegionOfInterestNode(std::map<std::string, RegionOfInterest> regions) : _regions(std::move(regions)) {}
+
+ImageData RegionOfInterestNode::process(ImageData const& data) {
+	static auto& stage = latency_stage("roi");
+	TraceScope scope(stage, data.trace);
+
+	ImageData ret;
+	ret.timestamp = data.timestamp;
+	ret.source = data.source;
+
+	if (auto const region = _regions.find(data.source); region == _regions.end()) {
+		ret.image = data.image;
+	} else if (region->second.mask.empty()) {
+		ret.image = data.image(region->second.crop);
+	} else {
+		// same gray as the letterbox border, so that the masked pixels look like padding to the detector
+		ret.image.create(region->second.crop.size(), data.image.type());
+		ret.image.setTo(cv::Scalar::all(114));
+		data.image(region->second.crop).copyTo(ret.image, region->second.mask);
+	}
+
+	ret.trace = scope.finish(ret.timestamp);
+	return ret;
+}
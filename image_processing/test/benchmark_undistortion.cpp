@@ -0,0 +1,69 @@
+#include <chrono>
+#include <functional>
+#include <map>
+#include <opencv2/opencv.hpp>
+#include <string>
+#include <string_view>
+
+#include "ImageUndistortionNode.h"
+#include "LatencyTracer.h"
+#include "common_output.h"
+#include "config.h"
+
+static std::uint64_t now() { return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count(); }
+
+/**
+ * @brief Measures the latency of undistorting one image of every camera after the other, like the cameras of one trigger arrive.
+ */
+void benchmark_undistortion(std::string_view const name, std::map<std::string, cv::Mat> const& images, int const rounds, std::function<void(std::string const&, cv::Mat const&)> const& undistort) {
+	LatencyHistogram histogram;
+
+	for (int round = 0; round < rounds; ++round) {
+		for (auto const& [camera, image] : images) {
+			std::uint64_t const start = now();
+			undistort(camera, image);
+			histogram.record(now() - start);
+		}
+	}
+
+	common::println(name, ": p50 ", histogram.percentile(0.5) / 1e6, " ms, p99 ", histogram.percentile(0.99) / 1e6, " ms, mean ", histogram.mean() / 1e6, " ms");
+}
+
+int main() {
+	constexpr int rounds = 100;
+
+	std::map<std::string, ImageUndistortionNode::UndistortionConfig> configs = {
+	    {"s110_n_cam_8", {config::intrinsic_matrix_s110_n_cam_8, config::distortion_values_s110_n_cam_8, config::optimal_camera_matrix_s110_n_cam_8, config::undistortion_map1_s110_n_cam_8, config::undistortion_map2_s110_n_cam_8}},
+	    {"s110_s_cam_8", {config::intrinsic_matrix_s110_s_cam_8, config::distortion_values_s110_s_cam_8, config::optimal_camera_matrix_s110_s_cam_8, config::undistortion_map1_s110_s_cam_8, config::undistortion_map2_s110_s_cam_8}},
+	    {"s110_w_cam_8", {config::intrinsic_matrix_s110_w_cam_8, config::distortion_values_s110_w_cam_8, config::optimal_camera_matrix_s110_w_cam_8, config::undistortion_map1_s110_w_cam_8, config::undistortion_map2_s110_w_cam_8}},
+	    {"s110_o_cam_8", {config::intrinsic_matrix_s110_o_cam_8, config::distortion_values_s110_o_cam_8, config::optimal_camera_matrix_s110_o_cam_8, config::undistortion_map1_s110_o_cam_8, config::undistortion_map2_s110_o_cam_8}}};
+
+	std::map<std::string, cv::Mat> images;
+	for (auto const& [camera, config] : configs) {
+		cv::Mat image(config.undistortion_map1.size(), CV_8UC3);
+		cv::randu(image, cv::Scalar::all(0), cv::Scalar::all(255));
+		images.emplace(camera, image);
+	}
+
+	// the implementation before the fixed-point maps: clone of the input, float maps, new output image every time
+	benchmark_undistortion("clone + float maps", images, rounds, [&configs](std::string const& camera, cv::Mat const& image) {
+		cv::Mat const distorted_image = image.clone();
+		cv::Mat undistorted_image;
+		cv::remap(distorted_image, undistorted_image, configs.at(camera).undistortion_map1, configs.at(camera).undistortion_map2, cv::INTER_LINEAR);
+	});
+
+	std::map<std::string, std::pair<cv::Mat, cv::Mat>> fixed_point_maps;
+	for (auto const& [camera, config] : configs) cv::convertMaps(config.undistortion_map1, config.undistortion_map2, fixed_point_maps[camera].first, fixed_point_maps[camera].second, CV_16SC2);
+	benchmark_undistortion("fixed-point maps", images, rounds, [&fixed_point_maps](std::string const& camera, cv::Mat const& image) {
+		cv::Mat undistorted_image;
+		cv::remap(image, undistorted_image, fixed_point_maps.at(camera).first, fixed_point_maps.at(camera).second, cv::INTER_LINEAR);
+	});
+
+	for (int const bands : {1, cv::getNumThreads()}) {
+		auto node_configs = configs;
+		ImageUndistortionNode undist(std::move(node_configs), bands);
+		auto& processor = static_cast<Processor<ImageData, ImageData>&>(undist);
+		benchmark_undistortion("ImageUndistortionNode " + std::to_string(bands) + " bands", images, rounds,
+		    [&processor](std::string const& camera, cv::Mat const& image) { processor.process(ImageData{image, 0, camera, {}}); });
+	}
+}
@@ -1,5 +1,6 @@
 #include <chrono>
 
+#include "FusedPreprocessingNode.h"
 #include "ImageDownscalingNode.h"
 #include "ImagePreprocessingNode.h"
 #include "ImageUndistortionNode.h"
@@ -18,18 +19,30 @@ int main(int argc, char** argv) {
 	ImageUndistortionNode undist(
 	    {{"s110_n_cam_8", {config::intrinsic_matrix_s110_n_cam_8, config::distortion_values_s110_n_cam_8, config::optimal_camera_matrix_s110_n_cam_8, config::undistortion_map1_s110_n_cam_8, config::undistortion_map2_s110_n_cam_8}}});
 	ImageDownscalingNode<640, 640> down;
+	// the detection branch only needs a fraction of the resolution, so the bayer cells are binned instead of demosaiced
+	ImagePreprocessingNode half_pre({{"s110_n_cam_8", {1200, 1920, cv::ColorConversionCodes::COLOR_BayerBG2BGR}}}, PreprocessingResolution::half);
+	ImageDownscalingNode<480, 640> half_down;
+	FusedPreprocessingNode<480, 640> fused({{"s110_n_cam_8", {1200, 1920, cv::ColorConversionCodes::COLOR_BayerBG2BGR, config::undistortion_map1_s110_n_cam_8, config::undistortion_map2_s110_n_cam_8}}});
 
 	ImageVisualizationNode raw_img([](ImageData const& data) { return data.source == "s110_n_cam_8"; });
 	ImageVisualizationNode down_img([](ImageData const& data) { return data.source == "s110_n_cam_8"; });
+	ImageVisualizationNode fused_img([](ImageData const& data) { return data.source == "s110_n_cam_8"; });
+	ImageVisualizationNode half_img([](ImageData const& data) { return data.source == "s110_n_cam_8"; });
 
 	raw_cams.asynchronously_connect(pre);
 	pre.synchronously_connect(raw_img);
 	pre.synchronously_connect(undist).synchronously_connect(raw_img);
 	pre.synchronously_connect(down);
 	undist.synchronously_connect(down).synchronously_connect(down_img);
+	raw_cams.asynchronously_connect(fused);
+	fused.synchronously_connect(fused_img);
+	raw_cams.asynchronously_connect(half_pre);
+	half_pre.synchronously_connect(half_down).synchronously_connect(half_img);
 
 	auto raw_cams_thread = raw_cams();
 	auto pre_thread = pre();
+	auto fused_thread = fused();
+	auto half_pre_thread = half_pre();
 
 	for (auto timestamp = std::chrono::system_clock::now() + 10s; std::chrono::system_clock::now() < timestamp; std::this_thread::yield()) g_main_context_iteration(NULL, true);
 }
\ No newline at end of file
@@ -0,0 +1,330 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <filesystem>
+#include <future>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "AsyncWriter.h"
+#include "FusedPreprocessingNode.h"
+#include "ImageDownscalingNode.h"
+#include "ImagePreprocessingNode.h"
+#include "ImageUndistortionNode.h"
+#include "MotionGateNode.h"
+#include "Runner.h"
+#include "common_output.h"
+#include "config.h"
+
+using namespace std::chrono_literals;
+
+/**
+ * @brief Renders a scene as the camera sees it before the bayer filter, with gradients and stripes down to a period of a few output pixels in every channel.
+ */
+static cv::Mat render_scene(int const height, int const width) {
+	cv::Mat scene(height, width, CV_8UC3);
+	for (int y = 0; y < height; ++y) {
+		auto* row = scene.ptr<std::uint8_t>(y);
+		for (int x = 0; x < width; ++x) {
+			row[x * 3] = static_cast<std::uint8_t>(std::lround(128. + 100. * std::sin(x / 37. + y / 53.)));
+			row[x * 3 + 1] = static_cast<std::uint8_t>(std::lround(128. + 90. * std::sin(x / 7.) * std::cos(y / 11.)));
+			row[x * 3 + 2] = static_cast<std::uint8_t>(std::lround(20. + 200. * x / width + 30. * std::sin(y / 5.)));
+		}
+	}
+	return scene;
+}
+
+/**
+ * @brief Keeps only the channel of the bayer filter at every pixel of the scene.
+ */
+static std::vector<std::uint8_t> mosaic(cv::Mat const& scene, cv::ColorConversionCodes const code) {
+	std::vector<std::uint8_t> raw(scene.total());
+	auto const offsets = bayer_channel_offsets(code, scene.cols);
+
+	// blue, green 1, green 2 and red
+	for (int channel = 0; channel < 4; ++channel) {
+		int const dx = offsets[channel] % scene.cols;
+		int const dy = offsets[channel] / scene.cols;
+		for (int y = dy; y < scene.rows; y += 2) {
+			for (int x = dx; x < scene.cols; x += 2) raw[y * scene.cols + x] = scene.at<cv::Vec3b>(y, x)[(channel + 1) / 2];
+		}
+	}
+	return raw;
+}
+
+/**
+ * @brief Compares two BGR images of the same size and fails if they differ by more than the tolerances.
+ *
+ * @param mean_tolerance The maximum mean absolute difference over all pixels and channels.
+ * @param max_tolerance The maximum absolute difference of any pixel and channel.
+ */
+static void expect_similar(std::string_view const name, cv::Mat const& image, cv::Mat const& expected, double const mean_tolerance, int const max_tolerance) {
+	if (image.type() != CV_8UC3 || expected.type() != CV_8UC3 || image.size() != expected.size()) common::println_critical_loc(name, ": the images differ in size or type!");
+
+	std::uint64_t sum = 0;
+	int max = 0;
+	for (int y = 0; y < image.rows; ++y) {
+		for (int i = 0; i < image.cols * 3; ++i) {
+			int const difference = std::abs(image.ptr<std::uint8_t>(y)[i] - expected.ptr<std::uint8_t>(y)[i]);
+			sum += difference;
+			max = std::max(max, difference);
+		}
+	}
+
+	double const mean = static_cast<double>(sum) / static_cast<double>(image.total() * 3);
+	common::println(name, ": mean absolute difference ", mean, " (tolerance ", mean_tolerance, "), max ", max, " (tolerance ", max_tolerance, ')');
+	if (mean > mean_tolerance || max > max_tolerance) common::println_critical_loc(name, " differs from the reference!");
+}
+
+/**
+ * @brief Letterboxes the image with cv::resize and cv::copyMakeBorder in the geometry of ImageDownscalingNode, as the reference for its box filter.
+ */
+static cv::Mat letterbox(cv::Mat const& image, int const height, int const width) {
+	float const resize_scale = std::min(static_cast<float>(height) / static_cast<float>(image.rows), static_cast<float>(width) / static_cast<float>(image.cols));
+	int const new_shape_w = static_cast<int>(std::round(static_cast<float>(image.cols) * resize_scale));
+	int const new_shape_h = static_cast<int>(std::round(static_cast<float>(image.rows) * resize_scale));
+	int const top = static_cast<int>(std::round(static_cast<float>(height - new_shape_h) / 2.f - 0.1));
+	int const left = static_cast<int>(std::round(static_cast<float>(width - new_shape_w) / 2.f - 0.1));
+
+	cv::Mat resized, ret;
+	cv::resize(image, resized, cv::Size(new_shape_w, new_shape_h), 0, 0, cv::INTER_AREA);
+	cv::copyMakeBorder(resized, ret, top, height - new_shape_h - top, left, width - new_shape_w - left, cv::BORDER_CONSTANT, cv::Scalar::all(114));
+	return ret;
+}
+
+/**
+ * @brief Compares the planes of a DownscalingOutput::chw_float image to a BGR image, the planes may deviate by the rounding of the BGR image to whole gray levels.
+ */
+static void expect_planes(std::string_view const name, cv::Mat const& planes, cv::Mat const& expected) {
+	if (planes.type() != CV_32FC1 || expected.type() != CV_8UC3 || planes.rows != 3 * expected.rows || planes.cols != expected.cols) common::println_critical_loc(name, ": the images differ in size or type!");
+
+	float max = 0.f;
+	for (int c = 0; c < 3; ++c) {
+		for (int y = 0; y < expected.rows; ++y) {
+			for (int x = 0; x < expected.cols; ++x) max = std::max(max, std::abs(planes.at<float>(c * expected.rows + y, x) - expected.at<cv::Vec3b>(y, x)[c] / 255.f));
+		}
+	}
+
+	common::println(name, ": max absolute difference ", max * 255.f, " gray levels (tolerance 0.5)");
+	if (max * 255.f > 0.5f + 1e-3f) common::println_critical_loc(name, " differs from the reference!");
+}
+
+/**
+ * @brief Bins cells x cells bayer cells into one BGR pixel the straightforward way, as the reference for the binning of ImagePreprocessingNode.
+ */
+static cv::Mat bin(std::vector<std::uint8_t> const& raw, int const rows, int const cols, cv::ColorConversionCodes const code, int const cells) {
+	auto const offsets = bayer_channel_offsets(code, cols);
+	cv::Mat ret(rows / (2 * cells), cols / (2 * cells), CV_8UC3);
+	for (int y = 0; y < ret.rows; ++y) {
+		for (int x = 0; x < ret.cols; ++x) {
+			double sums[3] = {};
+			for (int cy = 0; cy < cells; ++cy) {
+				for (int cx = 0; cx < cells; ++cx) {
+					for (int channel = 0; channel < 4; ++channel) sums[(channel + 1) / 2] += raw[2 * (y * cells + cy) * cols + 2 * (x * cells + cx) + offsets[channel]];
+				}
+			}
+
+			// blue and red have one sample per cell, green two
+			for (int c = 0; c < 3; ++c) ret.at<cv::Vec3b>(y, x)[c] = static_cast<std::uint8_t>(std::floor(sums[c] / (cells * cells * (c == 1 ? 2 : 1)) + 0.5));
+		}
+	}
+	return ret;
+}
+
+/**
+ * @brief Keeps the last image it received.
+ */
+class LastImageNode : public Runner<ImageData> {
+   public:
+	std::atomic<std::uint64_t> received = 0;
+	cv::Mat image;
+
+	void run(ImageData const& data) final {
+		image = data.image;
+		++received;
+	}
+};
+
+int main() {
+	// the fused preprocessing approximates ImagePreprocessingNode -> ImageUndistortionNode -> ImageDownscalingNode
+	{
+		ImageDataRaw const raw{mosaic(render_scene(1200, 1920), cv::COLOR_BayerBG2BGR), 0, "s110_n_cam_8"};
+
+		ImagePreprocessingNode pre({{"s110_n_cam_8", {1200, 1920, cv::ColorConversionCodes::COLOR_BayerBG2BGR}}});
+		ImageUndistortionNode undist(
+		    {{"s110_n_cam_8", {config::intrinsic_matrix_s110_n_cam_8, config::distortion_values_s110_n_cam_8, config::optimal_camera_matrix_s110_n_cam_8, config::undistortion_map1_s110_n_cam_8, config::undistortion_map2_s110_n_cam_8}}});
+		ImageDownscalingNode<480, 640> down;
+		FusedPreprocessingNode<480, 640> fused({{"s110_n_cam_8", {1200, 1920, cv::ColorConversionCodes::COLOR_BayerBG2BGR, {}, {}}}});
+		FusedPreprocessingNode<480, 640> fused_undist({{"s110_n_cam_8", {1200, 1920, cv::ColorConversionCodes::COLOR_BayerBG2BGR, config::undistortion_map1_s110_n_cam_8, config::undistortion_map2_s110_n_cam_8}}});
+
+		auto& pre_processor = static_cast<Processor<ImageDataRaw, ImageData>&>(pre);
+		auto& undist_processor = static_cast<Processor<ImageData, ImageData>&>(undist);
+		auto& down_processor = static_cast<Processor<ImageData, ImageData>&>(down);
+		auto& fused_processor = static_cast<Processor<ImageDataRaw, ImageData>&>(fused);
+		auto& fused_undist_processor = static_cast<Processor<ImageDataRaw, ImageData>&>(fused_undist);
+
+		ImageData const demosaiced = pre_processor.process(raw);
+
+		// without undistortion, the fused pass only differs in how the green channel is interpolated and in the rounding
+		expect_similar("fused preprocessing", fused_processor.process(raw).image, down_processor.process(demosaiced).image, 0.5, 8);
+
+		// the undistortion is sampled once per output pixel instead of once per full resolution pixel
+		expect_similar("fused preprocessing with undistortion", fused_undist_processor.process(raw).image, down_processor.process(undist_processor.process(demosaiced)).image, 1., 24);
+	}
+
+	// the binning node makes the binned and the full resolution image in one pass, they must not differ from binning and demosaicing the raw image separately
+	for (auto const resolution : {PreprocessingResolution::half, PreprocessingResolution::quarter}) {
+		cv::Mat bayer(1200, 1920, CV_8UC1);
+		cv::randu(bayer, cv::Scalar::all(0), cv::Scalar::all(256));
+		std::vector<std::uint8_t> bytes(bayer.ptr<std::uint8_t>(), bayer.ptr<std::uint8_t>() + bayer.total());
+		int const cells = resolution == PreprocessingResolution::half ? 1 : 2;
+		std::string const name = resolution == PreprocessingResolution::half ? "half resolution" : "quarter resolution";
+
+		cv::Mat const expected_binned = bin(bytes, 1200, 1920, cv::COLOR_BayerBG2BGR, cells);
+		cv::Mat expected_full;
+		cv::demosaicing(bayer, expected_full, cv::COLOR_BayerBG2BGR);
+
+		ImagePreprocessingNode binning({{"s110_n_cam_8", {1200, 1920, cv::ColorConversionCodes::COLOR_BayerBG2BGR}}}, resolution);
+		ImagePreprocessingNode binning_with_full({{"s110_n_cam_8", {1200, 1920, cv::ColorConversionCodes::COLOR_BayerBG2BGR}}}, resolution, 1);
+		LastImageNode full;
+		binning_with_full.full_resolution().synchronously_connect(full);
+
+		ImageDataRaw const raw{std::move(bytes), 0, "s110_n_cam_8"};
+		expect_similar(name + " binning", static_cast<Processor<ImageDataRaw, ImageData>&>(binning).process(raw).image, expected_binned, 0., 0);
+		expect_similar(name + " binning next to the full resolution", static_cast<Processor<ImageDataRaw, ImageData>&>(binning_with_full).process(raw).image, expected_binned, 0., 0);
+
+		{
+			auto full_resolution_thread = binning_with_full.full_resolution()();
+			for (auto const timeout = std::chrono::steady_clock::now() + 1s; !full.received && std::chrono::steady_clock::now() < timeout;) std::this_thread::sleep_for(1ms);
+		}
+
+		if (!full.received) common::println_critical_loc(name, " binning did not hand on the full resolution image!");
+		expect_similar(name + " full resolution", full.image, expected_full, 0., 0);
+	}
+
+	// the writer counts the frames it drops while its queue is full and the frames written after the late threshold
+	{
+		std::promise<void> open;
+		std::shared_future<void> const gate = open.get_future().share();
+		std::atomic<int> started = 0;
+		std::atomic<int> made = 0;
+
+		AsyncWriter<int> writer("writer", {.queue_capacity = 2, .threads = 1, .late_threshold = 50ms}, [&](std::filesystem::path const&, int const&) -> std::size_t {
+			++started;
+			gate.wait();
+			return sizeof(int);
+		});
+
+		// the first frame occupies the thread, so that the next two fill the queue
+		writer.push("0", 0);
+		while (!started) std::this_thread::sleep_for(1ms);
+		bool const queued = writer.push("1", 1) && writer.push("2", 2);
+		bool const dropped = !writer.push_lazily("3", [&made] { return ++made; });
+
+		std::this_thread::sleep_for(100ms);
+		open.set_value();
+		for (auto const timeout = std::chrono::steady_clock::now() + 1s; writer.statistics().written < 3 && std::chrono::steady_clock::now() < timeout;) std::this_thread::sleep_for(1ms);
+
+		writer.push("4", 4);
+		for (auto const timeout = std::chrono::steady_clock::now() + 1s; writer.statistics().written < 4 && std::chrono::steady_clock::now() < timeout;) std::this_thread::sleep_for(1ms);
+
+		writer.print_statistics();
+		auto const& statistics = writer.statistics();
+		if (!queued || !dropped || statistics.queued != 4 || statistics.dropped != 1) common::println_critical_loc("Writer did not drop exactly the frame that arrived while its queue was full!");
+		if (made) common::println_critical_loc("Writer made the data of a frame it dropped!");
+		if (statistics.written != 4 || statistics.late != 3) common::println_critical_loc("Writer did not count the 3 frames that waited for the disk as late!");
+	}
+
+	// the frames still queued when the writer is destroyed are written before the destructor returns
+	{
+		std::promise<void> open;
+		std::shared_future<void> const gate = open.get_future().share();
+		std::atomic<int> started = 0;
+		std::atomic<int> written = 0;
+		std::jthread opener;
+
+		{
+			AsyncWriter<int> writer("writer", {.queue_capacity = 4, .threads = 1}, [&](std::filesystem::path const&, int const&) -> std::size_t {
+				++started;
+				gate.wait();
+				++written;
+				return sizeof(int);
+			});
+
+			writer.push("0", 0);
+			while (!started) std::this_thread::sleep_for(1ms);
+			writer.push("1", 1);
+			writer.push("2", 2);
+
+			// the writer is destroyed while its thread still waits for the disk
+			opener = std::jthread([&open] {
+				std::this_thread::sleep_for(20ms);
+				open.set_value();
+			});
+		}
+
+		common::println("writer flushed ", written.load(), " of 3 frames on destruction");
+		if (written != 3) common::println_critical_loc("Writer did not write the queued frames before it was destroyed!");
+	}
+
+	// the motion gate lets the detector skip static frames, but not for longer than the max skip interval and never if something moved
+	{
+		MotionGateNode motion({.max_skip_interval = 300ms});
+		cv::Mat const background = render_scene(480, 640);
+		auto const gate = [&motion](cv::Mat const& image, std::uint64_t const milliseconds) { return motion.process(ImageData{image, milliseconds * 1'000'000, "s110_n_cam_8", {}}); };
+
+		bool const first_detected = !gate(background, 0).skip_detection;
+		ImageData const static_frame = gate(background, 100);
+		bool const static_skipped = gate(background, 200).skip_detection && static_frame.skip_detection && static_frame.motion.empty();
+		bool const forced = !gate(background, 300).skip_detection && motion.statistics().forced == 1;
+
+		// a slight change of the brightness everywhere stays below the threshold
+		cv::Mat brighter = background.clone();
+		for (int y = 0; y < brighter.rows; ++y) {
+			for (int i = 0; i < brighter.cols * 3; ++i) brighter.ptr<std::uint8_t>(y)[i] = static_cast<std::uint8_t>(std::min(brighter.ptr<std::uint8_t>(y)[i] + 3, 255));
+		}
+		bool const noise_skipped = gate(brighter, 400).skip_detection;
+
+		// an object that moves every frame is detected every frame, long before the max skip interval
+		bool moving_detected = true;
+		for (std::uint64_t frame = 0; frame < 5; ++frame) {
+			cv::Mat image = background.clone();
+			cv::Rect const object(100 + 40 * static_cast<int>(frame), 200, 40, 40);
+			image(object).setTo(cv::Scalar(255, 255, 255));
+
+			ImageData const gated = gate(image, 450 + 50 * frame);
+			moving_detected &= !gated.skip_detection && std::ranges::any_of(gated.motion, [&object](cv::Rect const& tile) { return (tile & object).area() > 0; });
+		}
+
+		motion.print_statistics();
+		if (!first_detected) common::println_critical_loc("Motion gate skipped the first image of a camera!");
+		if (!static_skipped) common::println_critical_loc("Motion gate did not skip the static frames!");
+		if (!forced) common::println_critical_loc("Motion gate did not force a detection after the max skip interval!");
+		if (!noise_skipped) common::println_critical_loc("Motion gate detected a change below the threshold!");
+		if (!moving_detected) common::println_critical_loc("Motion gate skipped a frame with a moving object or did not mark its tiles!");
+	}
+
+	// the box filter for integer factors matches cv::resize with cv::INTER_AREA exactly, the other sizes use cv::resize anyway
+	for (auto const& [rows, cols] : {std::pair{960, 1280}, std::pair{1440, 1920}, std::pair{1920, 2560}, std::pair{1200, 1920}, std::pair{1080, 1920}, std::pair{1000, 1000}}) {
+		cv::Mat image(rows, cols, CV_8UC3);
+		cv::randu(image, cv::Scalar::all(0), cv::Scalar::all(256));
+
+		ImageDownscalingNode<480, 640> down;
+		ImageDownscalingNode<480, 640, DownscalingOutput::chw_float> down_chw;
+		auto& down_processor = static_cast<Processor<ImageData, ImageData>&>(down);
+		auto& down_chw_processor = static_cast<Processor<ImageData, ImageData>&>(down_chw);
+
+		ImageData const data{image, 0, "s110_n_cam_8", {}};
+		cv::Mat const expected = letterbox(image, 480, 640);
+		std::string const name = "downscaling " + std::to_string(rows) + 'x' + std::to_string(cols);
+
+		expect_similar(name, down_processor.process(data).image, expected, 0., 0);
+		expect_planes(name + " to planes", down_chw_processor.process(data).image, expected);
+	}
+}
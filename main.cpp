@@ -1,16 +1,22 @@
 #include <chrono>
+#include <optional>
 
+#include "BatchedYoloNode.h"
 #include "BirdEyeVisualizationNode.h"
+#include "BoundedEdgeNode.h"
 #include "CamerasSimulatorNode.h"
 #include "DrawingUtils.h"
 #include "ImageDownscalingNode.h"
 #include "ImagePreprocessingNode.h"
 #include "ImageTrackerNode.h"
 #include "ImageVisualizationNode.h"
+#include "LatencyTracer.h"
+#include "MotionGateNode.h"
+#include "PipelineGraph.h"
 #include "StreamingDataNode.h"
 #include "StreamingImageNode.h"
+#include "ThreadPlacement.h"
 #include "TrackToTrackFusion.h"
-#include "YoloNode.h"
 #include "config.h"
 
 using namespace std::chrono_literals;
@@ -33,37 +39,74 @@ int main(int argc, char** argv) {
 		        {"s110_s_cam_8", std::filesystem::path(CMAKE_SOURCE_DIR) / "data" / "tumtraf_v2x_cooperative_perception_dataset" / "test" / "images" / "s110_camera_basler_south2_8mm"}});
 		// ImagePreprocessingNode pre({{"s110_n_cam_8", {1200, 1920, cv::ColorConversionCodes::COLOR_BayerBG2BGR}}, {"s110_w_cam_8", {1200, 1920, cv::ColorConversionCodes::COLOR_BayerBG2BGR}},
 		//     {"s110_s_cam_8", {1200, 1920, cv::ColorConversionCodes::COLOR_BayerBG2BGR}}, {"s110_o_cam_8", {1200, 1920, cv::ColorConversionCodes::COLOR_BayerBG2BGR}}});
-		ImageDownscalingNode<480, 640> down;
-		YoloNode<480, 640> yolo(
-		    {{"s110_n_cam_8", {1200, 1920}}, {"s110_s_cam_8", {1200, 1920}}, {"s110_o_cam_8", {1200, 1920}}, {"s110_w_cam_8", {1200, 1920}}}, std::filesystem::path(CMAKE_SOURCE_DIR) / "data" / "yolo" / "480x640" / "yolo11m.torchscript");
+		ImageDownscalingNode<480, 640, DownscalingOutput::chw_float> down;
+		// the frames of one trigger of the four cameras are detected in one batch, the detections keep the order per camera for the tracker
+		BatchedYoloNode<480, 640> yolo({{"s110_n_cam_8", {1200, 1920}}, {"s110_s_cam_8", {1200, 1920}}, {"s110_o_cam_8", {1200, 1920}}, {"s110_w_cam_8", {1200, 1920}}},
+		    std::filesystem::path(CMAKE_SOURCE_DIR) / "data" / "yolo" / "480x640" / "yolo11m.torchscript", {.max_batch_size = 4, .window = 10ms});
 		ImageTrackerNode track;
 		TrackToTrackFusionNode fusion({{"s110_n_cam_8", {config::projection_matrix_s110_base_north_into_s110_n_cam_8, config::affine_transformation_utm_to_s110_base_north}},
 		    {"s110_o_cam_8", {config::projection_matrix_s110_base_north_into_s110_o_cam_8, config::affine_transformation_utm_to_s110_base_north}},
 		    {"s110_s_cam_8", {config::projection_matrix_s110_base_north_into_s110_s_cam_8, config::affine_transformation_utm_to_s110_base_north}},
 		    {"s110_w_cam_8", {config::projection_matrix_s110_base_north_into_s110_w_cam_8, config::affine_transformation_utm_to_s110_base_north}}});
 
-		BirdEyeVisualizationNode<CompactObjects> vis(map, utm_to_image);
+		BirdEyeVisualizationNode<Shared<CompactObjects>> vis(map, utm_to_image);
 		ImageVisualizationNode img([](ImageData const& data) { return data.source == "bird"; });
 		StreamingImageNode stream;
 		StreamingDataNode data_stream;
 
-		cams.asynchronously_connect(down);
-		down.asynchronously_connect(yolo);
-		yolo.asynchronously_connect(track);
-		track.synchronously_connect(fusion);
-		fusion.asynchronously_connect(data_stream);
-		fusion.asynchronously_connect(vis);
-		vis.synchronously_connect(img);
-		vis.asynchronously_connect(stream);
+		// only the latest frame of every camera waits in front of the inference, so that the processed frames are always fresh
+		BoundedEdgeNode<ImageData> down_to_yolo("down->yolo", 4, OverflowPolicy::latest_per_source);
+		// behind the edge, so that every frame the gate lets pass is detected, the tracker coasts over the skipped static frames
+		MotionGateNode motion;
+		// the visualization and the stream are best effort: their edges only keep the latest message and never block the fusion, so they cannot hold back the detection
+		BoundedEdgeNode<Shared<CompactObjects>> fusion_to_vis("fusion->vis", 1, OverflowPolicy::drop_oldest);
+		BoundedEdgeNode<ImageData> vis_to_stream("vis->stream", 1, OverflowPolicy::drop_oldest);
 
-		auto cams_thread = cams();
-		auto down_thread = down();
-		auto yolo_thread = yolo();
-		auto track_thread = track();
-		auto vis_thread = vis();
-		auto stream_thread = stream();
-		auto data_stream_thread = data_stream();
+		// the inference and the intra-op threads it spawns run on the upper half of the cores, the visualization only runs when nothing else wants the cpu
+		std::optional<ThreadPlacementConfig> inference_placement;
+		if (int const cores = static_cast<int>(std::thread::hardware_concurrency()); cores >= 8) {
+			inference_placement.emplace(ThreadPlacementConfig{.cpus = {}, .policy = SchedulingPolicy::other});
+			for (int core = cores / 2; core < cores; ++core) inference_placement->cpus.push_back(core);
+		}
+
+		PipelineGraph graph;
+		graph.add("cams", cams);
+		graph.add("down", down);
+		graph.add("down->yolo", down_to_yolo);
+		graph.add("motion", motion);
+		graph.add("yolo", yolo, {.isolated = false, .placement = inference_placement});
+		graph.add("track", track);
+		graph.add("fusion", fusion);
+		graph.add("fusion->vis", fusion_to_vis, {.isolated = false, .placement = ThreadPlacementConfig{.cpus = {}, .policy = SchedulingPolicy::idle}});
+		graph.add("vis", vis);
+		graph.add("img", img);
+		graph.add("vis->stream", vis_to_stream, {.isolated = false, .placement = ThreadPlacementConfig{.cpus = {}, .policy = SchedulingPolicy::idle}});
+		graph.add("stream", stream);
+		graph.add("data_stream", data_stream);
+
+		graph.connect(cams, down);
+		graph.connect(down, down_to_yolo);
+		graph.connect(down_to_yolo, motion);
+		graph.connect(motion, yolo);
+		graph.connect(yolo, track);
+		graph.connect(track, fusion);
+		graph.connect(fusion, data_stream);
+		graph.connect(fusion, fusion_to_vis, Connection::synchronous);
+		graph.connect(fusion_to_vis, vis);
+		// the gtk window must be fed from the thread of the visualization
+		graph.connect(vis, img, Connection::synchronous);
+		graph.connect(vis, vis_to_stream, Connection::synchronous);
+		graph.connect(vis_to_stream, stream);
+
+		auto pipeline = graph.start();
+		print_thread_placement_report();
 
 		for (auto timestamp = std::chrono::system_clock::now() + 40s; std::chrono::system_clock::now() < timestamp; std::this_thread::yield()) g_main_context_iteration(NULL, true);
+
+		down_to_yolo.print_statistics();
+		fusion_to_vis.print_statistics();
+		vis_to_stream.print_statistics();
+		motion.print_statistics();
+		print_latency_statistics();
 	}
 }
\ No newline at end of file
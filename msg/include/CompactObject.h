@@ -19,4 +19,5 @@ struct CompactObject {
 struct CompactObjects {
 	std::uint64_t timestamp;             // UTC timestamp since epoch in ns
 	std::vector<CompactObject> objects;  // vector of objects
+	Trace trace;                         // latency trace of the nodes the objects passed through
 };
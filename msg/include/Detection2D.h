@@ -4,6 +4,8 @@
 #include <string>
 #include <vector>
 
+#include "Trace.h"
+
 struct BoundingBoxXYXY {
 	double left;
 	double top;
@@ -21,4 +23,6 @@ struct Detections2D {
 	std::uint64_t timestamp;           // UTC timestamp since epoch in ns
 	std::string source;                // sensor source of detections
 	std::vector<Detection2D> objects;  // vector of detections
+	Trace trace;                       // latency trace of the nodes the detections passed through
+	bool coasting = false;             // the detector skipped the frame because nothing moved, so objects is empty and the trackers only predict
 };
\ No newline at end of file
@@ -0,0 +1,17 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * @brief The frames of several cameras that were captured on the same trigger pulse.
+ *
+ * @tparam Frame The message type of one camera, e.g. ImageData.
+ */
+template <typename Frame>
+struct FrameSet {
+	std::uint64_t timestamp;           // earliest ptp timestamp of the frames in ns
+	std::vector<Frame> frames;         // frames that arrived in time, in the order of the configured cameras
+	std::vector<std::string> missing;  // cameras without a frame in this set
+};
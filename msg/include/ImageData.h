@@ -3,9 +3,16 @@
 #include <cstdint>
 #include <opencv2/opencv.hpp>
 #include <string>
+#include <vector>
+
+#include "Trace.h"
 
 struct ImageData {
 	cv::Mat image;
 	std::uint64_t timestamp;  // UTC timestamp since epoch in ns
 	std::string source;
+	Trace trace;  // latency trace of the nodes the image passed through
+
+	bool skip_detection = false;   // set by MotionGateNode if nothing changed since the last detection of the source, the detector does not run on the image
+	std::vector<cv::Rect> motion;  // regions that changed since the last detection of the source, set by MotionGateNode
 };
\ No newline at end of file
@@ -2,10 +2,11 @@
 
 #include <cstdint>
 #include <string>
-#include <vector>
+
+#include "RawBuffer.h"
 
 struct ImageDataRaw {
-	std::vector<std::uint8_t> image_raw;
+	RawBuffer image_raw;
 	std::uint64_t timestamp;
 	std::string source;
 };
\ No newline at end of file
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+
+/**
+ * @class RawBuffer
+ * @brief Immutable bytes of a raw image that are either owned or a view into memory kept alive by an owner, e.g. a memory-mapped recording.
+ *
+ * Copying a RawBuffer only copies the reference to the owner, so the bytes are never copied when the message is handed to several nodes.
+ */
+class RawBuffer {
+	std::shared_ptr<void const> _owner;
+	std::uint8_t const* _data = nullptr;
+	std::size_t _size = 0;
+
+   public:
+	RawBuffer() = default;
+
+	/**
+	 * @brief Takes over the bytes.
+	 */
+	RawBuffer(std::vector<std::uint8_t>&& bytes) {
+		auto owner = std::make_shared<std::vector<std::uint8_t> const>(std::move(bytes));
+		_data = owner->data();
+		_size = owner->size();
+		_owner = std::move(owner);
+	}
+
+	/**
+	 * @brief Views the bytes without copying.
+	 *
+	 * @param owner Keeps the bytes alive as long as the buffer or a copy of it exists.
+	 * @param data The first byte.
+	 * @param size The number of bytes.
+	 */
+	RawBuffer(std::shared_ptr<void const> owner, std::uint8_t const* data, std::size_t const size) : _owner(std::move(owner)), _data(data), _size(size) {}
+
+	[[nodiscard]] std::uint8_t const* data() const { return _data; }
+	[[nodiscard]] std::size_t size() const { return _size; }
+	[[nodiscard]] bool empty() const { return _size == 0; }
+	[[nodiscard]] std::uint8_t const* begin() const { return _data; }
+	[[nodiscard]] std::uint8_t const* end() const { return _data + _size; }
+};
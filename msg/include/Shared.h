@@ -0,0 +1,54 @@
+#pragma once
+
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+/**
+ * @class Shared
+ * @brief Immutable, reference-counted envelope for messages that are handed from node to node.
+ *
+ * Copying a Shared<T> only copies a pointer. Fanning out one message to several consumers therefore does not deep-copy the payload.
+ * The payload is const once the envelope is created, so every consumer may read it concurrently without synchronization.
+ *
+ * @tparam T The message type, e.g. CompactObjects.
+ */
+template <typename T>
+class Shared {
+	std::shared_ptr<T const> _data;
+
+   public:
+	Shared() = default;
+	explicit Shared(T data) : _data(std::make_shared<T const>(std::move(data))) {}
+
+	T const& operator*() const { return *_data; }
+	T const* operator->() const { return _data.get(); }
+	explicit operator bool() const { return static_cast<bool>(_data); }
+
+	[[nodiscard]] T const& get() const { return *_data; }
+	[[nodiscard]] long use_count() const { return _data.use_count(); }
+};
+
+/**
+ * @brief Moves a message into a new Shared envelope.
+ */
+template <typename T>
+Shared<std::remove_cvref_t<T>> make_shared_message(T&& data) {
+	return Shared<std::remove_cvref_t<T>>(std::forward<T>(data));
+}
+
+template <typename T>
+struct is_shared_message : std::false_type {};
+template <typename T>
+struct is_shared_message<Shared<T>> : std::true_type {};
+
+/**
+ * @brief Returns the payload of a message, regardless of whether it is wrapped in a Shared envelope or not.
+ */
+template <typename T>
+decltype(auto) unwrap_message(T const& message) {
+	if constexpr (is_shared_message<T>::value)
+		return *message;
+	else
+		return (message);
+}
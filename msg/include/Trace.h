@@ -0,0 +1,16 @@
+#pragma once
+
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+struct TraceSpan {
+	std::string_view stage;    // name of the node, must refer to static storage
+	std::uint64_t enter;       // UTC timestamp since epoch in ns when the node started processing the message
+	std::uint64_t exit;        // UTC timestamp since epoch in ns when the node finished processing the message
+	std::uint64_t queue_wait;  // ns the message waited between the previous node and this node
+};
+
+struct Trace {
+	std::vector<TraceSpan> spans;  // nodes the message and its predecessors passed through, in order
+};
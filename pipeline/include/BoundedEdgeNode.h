@@ -0,0 +1,93 @@
+#pragma once
+
+#include <functional>
+#include <optional>
+#include <stop_token>
+#include <string>
+#include <utility>
+
+#include "BoundedQueue.h"
+#include "Pusher.h"
+#include "Runner.h"
+#include "common_output.h"
+
+/**
+ * @class BoundedEdgeNode
+ * @brief An asynchronous edge with a bounded queue and a selectable overflow policy.
+ *
+ * Replaces a.asynchronously_connect(b), whose queue is unbounded, with:
+ * @code
+ * BoundedEdgeNode<ImageData> edge("down->yolo", 1, OverflowPolicy::latest_per_source);
+ * a.synchronously_connect(edge.input());
+ * edge.synchronously_connect(b);
+ * auto edge_thread = edge();
+ * @endcode
+ * The producer enqueues in its own thread, the consumer runs in the thread of the edge.
+ * Stopping the thread of the edge closes the queue, so that neither the edge nor a producer blocked by OverflowPolicy::block keeps the thread from being joined.
+ *
+ * @tparam T The message type that is passed along the edge.
+ */
+template <typename T>
+class BoundedEdgeNode : public Pusher<T> {
+	std::string _name;
+	BoundedQueue<T> _queue;
+
+	class Input : public Runner<T> {
+		BoundedQueue<T>& _queue;
+
+	   public:
+		explicit Input(BoundedQueue<T>& queue) : _queue(queue) {}
+		void run(T const& data) final { _queue.push(data); }
+	} _input;
+
+	std::optional<std::stop_callback<std::function<void()>>> _close_on_stop;
+
+   public:
+	/**
+	 * @param name The name of the edge used in the statistics output.
+	 * @param capacity The maximum number of queued messages.
+	 * @param policy What happens to arriving messages while the queue is full.
+	 */
+	BoundedEdgeNode(std::string name, std::size_t const capacity, OverflowPolicy const policy) : _name(std::move(name)), _queue(capacity, policy), _input(_queue) {}
+
+	/**
+	 * @brief The node the producer is synchronously connected to.
+	 */
+	Runner<T>& input() { return _input; }
+
+	/**
+	 * @brief Enqueues a message like input() does, but tells the caller whether it was accepted.
+	 * @return True, if the message was enqueued, false if it was dropped or the edge is closed.
+	 */
+	bool enqueue(T const& data) { return _queue.push(data); }
+
+	/**
+	 * @brief Hands the oldest queued message to the consumer, waits until one is available.
+	 *
+	 * @return The message or an empty message once the edge is stopped, like ReceivingImageNode does.
+	 */
+	T push() final {
+		if (!_close_on_stop) _close_on_stop.emplace(this->stop_token, [this] { _queue.close(); });
+
+		if (auto data = _queue.pop()) return std::move(*data);
+		return T{};
+	}
+
+	/**
+	 * @brief Closes the edge: the producer can no longer enqueue and the consumer stops waiting.
+	 */
+	void close() { _queue.close(); }
+
+	[[nodiscard]] std::string const& name() const { return _name; }
+	[[nodiscard]] std::size_t size() const { return _queue.size(); }
+	[[nodiscard]] QueueStatistics const& statistics() const { return _queue.statistics(); }
+
+	/**
+	 * @brief Prints the counters of the edge.
+	 */
+	void print_statistics() const {
+		auto const& statistics = _queue.statistics();
+		common::println(_name, " (", to_string(_queue.policy()), ", capacity ", _queue.capacity(), "): pushed ", statistics.pushed.load(), ", popped ", statistics.popped.load(), ", dropped ", statistics.dropped.load(),
+		    ", blocked ", statistics.blocked.load(), ", high water ", statistics.high_water.load());
+	}
+};
@@ -0,0 +1,196 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+
+#include "Shared.h"
+#include "common_output.h"
+
+/**
+ * @brief Describes what a bounded queue does when a new element arrives while it is full.
+ */
+enum class OverflowPolicy {
+	block,             ///< The producer waits until the consumer made room.
+	drop_oldest,       ///< The oldest queued element is discarded.
+	drop_newest,       ///< The arriving element is discarded.
+	latest_per_source  ///< Only the latest element of every source is kept, a newer one replaces the queued one in place.
+};
+
+/**
+ * @brief Returns the name of the overflow policy.
+ */
+constexpr std::string_view to_string(OverflowPolicy const policy) {
+	switch (policy) {
+		case OverflowPolicy::block: return "block";
+		case OverflowPolicy::drop_oldest: return "drop_oldest";
+		case OverflowPolicy::drop_newest: return "drop_newest";
+		case OverflowPolicy::latest_per_source: return "latest_per_source";
+	}
+	return "unknown";
+}
+
+/**
+ * @brief Counters of a bounded queue. They can be read from any thread while the queue is in use.
+ */
+struct QueueStatistics {
+	std::atomic<std::uint64_t> pushed = 0;      ///< Number of elements offered by the producer.
+	std::atomic<std::uint64_t> popped = 0;      ///< Number of elements handed to the consumer.
+	std::atomic<std::uint64_t> dropped = 0;     ///< Number of elements discarded by the overflow policy.
+	std::atomic<std::uint64_t> high_water = 0;  ///< Highest number of elements that were queued at the same time.
+	std::atomic<std::uint64_t> blocked = 0;     ///< Number of times the producer had to wait for room.
+};
+
+/**
+ * @class BoundedQueue
+ * @brief A mutex-protected, fixed-capacity FIFO between one or more producers and one consumer.
+ *
+ * Closing the queue wakes all waiting threads: producers can no longer enqueue, the consumer still gets the queued elements and then an empty result instead of waiting.
+ *
+ * @tparam T The element type. For OverflowPolicy::latest_per_source it must have a source member, possibly wrapped in a Shared envelope.
+ */
+template <typename T>
+class BoundedQueue {
+	std::deque<T> _queue;
+	std::size_t const _capacity;
+	OverflowPolicy const _policy;
+
+	mutable std::mutex _mutex;
+	std::condition_variable _not_empty;
+	std::condition_variable _not_full;
+	bool _closed = false;
+
+	QueueStatistics _statistics;
+
+	static constexpr bool has_source = requires(T const& t) { unwrap_message(t).source; };
+
+	void update_high_water() {
+		std::uint64_t const size = _queue.size();
+		for (auto high_water = _statistics.high_water.load(std::memory_order_relaxed); high_water < size && !_statistics.high_water.compare_exchange_weak(high_water, size, std::memory_order_relaxed);) {
+		}
+	}
+
+   public:
+	/**
+	 * @param capacity The maximum number of queued elements, at least 1.
+	 * @param policy What happens to arriving elements while the queue is full.
+	 */
+	explicit BoundedQueue(std::size_t const capacity, OverflowPolicy const policy = OverflowPolicy::block) : _capacity(std::max<std::size_t>(capacity, 1)), _policy(policy) {
+		if (policy == OverflowPolicy::latest_per_source && !has_source) common::println_critical_loc("OverflowPolicy::latest_per_source needs a message type with a source member!");
+	}
+
+	/**
+	 * @brief Enqueues an element according to the overflow policy.
+	 *
+	 * @param data The element to be enqueued.
+	 * @return True, if the element was enqueued, false if it was dropped or the queue is closed.
+	 */
+	template <typename U>
+	bool push(U&& data) {
+		std::unique_lock lock(_mutex);
+		if (_closed) return false;
+		_statistics.pushed.fetch_add(1, std::memory_order_relaxed);
+
+		if constexpr (has_source) {
+			if (_policy == OverflowPolicy::latest_per_source) {
+				auto const& source = unwrap_message(data).source;
+				if (auto it = std::find_if(_queue.begin(), _queue.end(), [&source](T const& queued) { return unwrap_message(queued).source == source; }); it != _queue.end()) {
+					*it = std::forward<U>(data);
+					_statistics.dropped.fetch_add(1, std::memory_order_relaxed);
+					return true;
+				}
+			}
+		}
+
+		if (_queue.size() >= _capacity) {
+			switch (_policy) {
+				case OverflowPolicy::block:
+					_statistics.blocked.fetch_add(1, std::memory_order_relaxed);
+					_not_full.wait(lock, [this] { return _queue.size() < _capacity || _closed; });
+					if (_closed) return false;
+					break;
+				case OverflowPolicy::drop_newest: _statistics.dropped.fetch_add(1, std::memory_order_relaxed); return false;
+				case OverflowPolicy::drop_oldest:
+				case OverflowPolicy::latest_per_source:
+					_queue.pop_front();
+					_statistics.dropped.fetch_add(1, std::memory_order_relaxed);
+					break;
+			}
+		}
+
+		_queue.emplace_back(std::forward<U>(data));
+		update_high_water();
+
+		lock.unlock();
+		_not_empty.notify_one();
+		return true;
+	}
+
+	/**
+	 * @brief Dequeues the oldest element, waits until one is available.
+	 *
+	 * @return The element or std::nullopt if the queue is closed and empty.
+	 */
+	std::optional<T> pop() {
+		std::unique_lock lock(_mutex);
+		_not_empty.wait(lock, [this] { return !_queue.empty() || _closed; });
+		if (_queue.empty()) return std::nullopt;
+
+		std::optional<T> ret(std::move(_queue.front()));
+		_queue.pop_front();
+		_statistics.popped.fetch_add(1, std::memory_order_relaxed);
+
+		lock.unlock();
+		_not_full.notify_one();
+		return ret;
+	}
+
+	/**
+	 * @brief Dequeues the oldest element, waits at most until the deadline for one to become available.
+	 *
+	 * @return The element or std::nullopt if the deadline passed while the queue was empty or the queue is closed and empty.
+	 */
+	std::optional<T> pop_until(std::chrono::steady_clock::time_point const deadline) {
+		std::unique_lock lock(_mutex);
+		if (!_not_empty.wait_until(lock, deadline, [this] { return !_queue.empty() || _closed; }) || _queue.empty()) return std::nullopt;
+
+		std::optional<T> ret(std::move(_queue.front()));
+		_queue.pop_front();
+		_statistics.popped.fetch_add(1, std::memory_order_relaxed);
+
+		lock.unlock();
+		_not_full.notify_one();
+		return ret;
+	}
+
+	/**
+	 * @brief Closes the queue and wakes all waiting producers and the consumer, e.g. to stop the thread of an edge.
+	 */
+	void close() {
+		{
+			std::scoped_lock lock(_mutex);
+			_closed = true;
+		}
+		_not_empty.notify_all();
+		_not_full.notify_all();
+	}
+
+	[[nodiscard]] bool closed() const {
+		std::scoped_lock lock(_mutex);
+		return _closed;
+	}
+	[[nodiscard]] std::size_t size() const {
+		std::scoped_lock lock(_mutex);
+		return _queue.size();
+	}
+	[[nodiscard]] std::size_t capacity() const { return _capacity; }
+	[[nodiscard]] OverflowPolicy policy() const { return _policy; }
+	[[nodiscard]] QueueStatistics const& statistics() const { return _statistics; }
+};
@@ -0,0 +1,198 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <stop_token>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "FrameSet.h"
+#include "Pusher.h"
+#include "Runner.h"
+#include "common_output.h"
+
+/**
+ * @brief Counters of a frame set assembly. They can be read from any thread while the assembly is in use.
+ */
+struct FrameSetStatistics {
+	std::atomic<std::uint64_t> complete = 0;    ///< Number of sets handed on with a frame of every camera.
+	std::atomic<std::uint64_t> incomplete = 0;  ///< Number of sets handed on after the timeout with missing frames.
+	std::atomic<std::uint64_t> late = 0;        ///< Number of frames dropped because their set was already handed on.
+	std::atomic<std::uint64_t> duplicate = 0;   ///< Number of frames dropped because their set already had a frame of the camera.
+	std::atomic<std::uint64_t> unknown = 0;     ///< Number of frames dropped because their camera is not part of the set.
+};
+
+/**
+ * @class FrameSetAssemblyNode
+ * @brief Groups the frames of hardware-triggered cameras that belong to the same trigger pulse into one FrameSet.
+ *
+ * A frame belongs to a set if its ptp timestamp lies within the tolerance of the first frame of the set.
+ * A set is handed on as soon as every camera delivered, or with the missing cameras listed once the timeout expired.
+ * Sets are handed on in timestamp order, so a frame that arrives after its set was handed on is dropped as late.
+ *
+ * Wired like BoundedEdgeNode:
+ * @code
+ * FrameSetAssemblyNode<ImageData> assembly({"s110_n_cam_8", "s110_o_cam_8", "s110_s_cam_8", "s110_w_cam_8"}, 2ms, 50ms);
+ * pre.synchronously_connect(assembly.input());
+ * assembly.synchronously_connect(yolo);
+ * auto assembly_thread = assembly();
+ * @endcode
+ * The producers add their frames in their own threads, the consumer runs in the thread of the assembly.
+ * Stopping the thread of the assembly closes it like BoundedEdgeNode, so that the consumer does not wait for cameras that no longer send frames.
+ *
+ * @tparam Frame The message type of one camera, it must have a timestamp and a source member.
+ */
+template <typename Frame>
+class FrameSetAssemblyNode : public Pusher<FrameSet<Frame>> {
+	struct PendingSet {
+		std::uint64_t reference;  // timestamp of the first frame of the set
+		std::chrono::steady_clock::time_point deadline;
+		std::vector<std::optional<Frame>> frames;  // indexed like the cameras
+		std::size_t count = 0;
+	};
+
+	std::vector<std::string> const _sources;
+	std::uint64_t const _tolerance;
+	std::chrono::nanoseconds const _timeout;
+
+	std::mutex _mutex;
+	std::condition_variable _changed;
+	std::deque<PendingSet> _pending;  // ordered by reference timestamp
+	std::optional<std::uint64_t> _last_reference;
+	bool _closed = false;
+
+	FrameSetStatistics _statistics;
+	std::optional<std::stop_callback<std::function<void()>>> _close_on_stop;
+
+	class Input : public Runner<Frame> {
+		FrameSetAssemblyNode& _node;
+
+	   public:
+		explicit Input(FrameSetAssemblyNode& node) : _node(node) {}
+		void run(Frame const& frame) final { _node.add(frame); }
+	} _input;
+
+	void add(Frame const& frame) {
+		auto const source = std::ranges::find(_sources, frame.source);
+		if (source == _sources.end()) {
+			_statistics.unknown.fetch_add(1, std::memory_order_relaxed);
+			return;
+		}
+		auto const camera = static_cast<std::size_t>(source - _sources.begin());
+
+		{
+			std::scoped_lock lock(_mutex);
+			if (_closed) return;
+
+			if (_last_reference && frame.timestamp <= *_last_reference + _tolerance) {
+				_statistics.late.fetch_add(1, std::memory_order_relaxed);
+				return;
+			}
+
+			auto const distance = [&frame](std::uint64_t const reference) { return frame.timestamp > reference ? frame.timestamp - reference : reference - frame.timestamp; };
+			auto pending = std::ranges::find_if(_pending, [&](PendingSet const& set) { return distance(set.reference) <= _tolerance; });
+
+			if (pending == _pending.end()) {
+				pending = _pending.insert(std::ranges::upper_bound(_pending, frame.timestamp, {}, &PendingSet::reference),
+				    PendingSet{frame.timestamp, std::chrono::steady_clock::now() + _timeout, std::vector<std::optional<Frame>>(_sources.size()), 0});
+			} else if (pending->frames[camera]) {
+				_statistics.duplicate.fetch_add(1, std::memory_order_relaxed);
+				return;
+			}
+
+			pending->frames[camera] = frame;
+			++pending->count;
+		}
+
+		_changed.notify_one();
+	}
+
+   public:
+	/**
+	 * @param sources The cameras that are triggered together.
+	 * @param tolerance The maximum difference of the timestamps of frames of the same trigger pulse, well below the trigger period.
+	 * @param timeout How long a set waits for late or missing frames after its first frame arrived.
+	 */
+	FrameSetAssemblyNode(std::vector<std::string> sources, std::chrono::nanoseconds const tolerance, std::chrono::nanoseconds const timeout)
+	    : _sources(std::move(sources)), _tolerance(static_cast<std::uint64_t>(tolerance.count())), _timeout(timeout), _input(*this) {
+		if (_sources.empty()) common::println_critical_loc("A frame set needs at least one camera!");
+		if (tolerance.count() < 0 || timeout.count() < 0) common::println_critical_loc("Tolerance and timeout of the frame set assembly must not be negative!");
+	}
+
+	/**
+	 * @brief The node the producers are synchronously connected to.
+	 */
+	Runner<Frame>& input() { return _input; }
+
+	/**
+	 * @brief Hands the oldest set to the consumer, waits until it is complete or its timeout expired.
+	 *
+	 * Once the assembly is closed, the pending sets are handed on without waiting for their missing frames.
+	 *
+	 * @return The set or an empty set once the assembly is closed and no set is pending, like BoundedEdgeNode does.
+	 */
+	FrameSet<Frame> push() final {
+		if (!_close_on_stop) _close_on_stop.emplace(this->stop_token, [this] { close(); });
+
+		std::unique_lock lock(_mutex);
+		for (;;) {
+			if (_pending.empty()) {
+				if (_closed) return FrameSet<Frame>{};
+				_changed.wait(lock);
+				continue;
+			}
+
+			auto const& oldest = _pending.front();
+			if (_closed || oldest.count == _sources.size() || std::chrono::steady_clock::now() >= oldest.deadline) break;
+			_changed.wait_until(lock, oldest.deadline);
+		}
+
+		PendingSet pending = std::move(_pending.front());
+		_pending.pop_front();
+		_last_reference = pending.reference;
+		lock.unlock();
+
+		FrameSet<Frame> set{pending.reference, {}, {}};
+		set.frames.reserve(pending.count);
+		for (std::size_t i = 0; i < _sources.size(); ++i) {
+			if (pending.frames[i]) {
+				set.timestamp = std::min(set.timestamp, pending.frames[i]->timestamp);
+				set.frames.push_back(std::move(*pending.frames[i]));
+			} else {
+				set.missing.push_back(_sources[i]);
+			}
+		}
+
+		(set.missing.empty() ? _statistics.complete : _statistics.incomplete).fetch_add(1, std::memory_order_relaxed);
+		return set;
+	}
+
+	/**
+	 * @brief Closes the assembly: the producers can no longer add frames and the consumer stops waiting.
+	 */
+	void close() {
+		{
+			std::scoped_lock lock(_mutex);
+			_closed = true;
+		}
+		_changed.notify_all();
+	}
+
+	[[nodiscard]] FrameSetStatistics const& statistics() const { return _statistics; }
+
+	/**
+	 * @brief Prints the counters of the assembly.
+	 */
+	void print_statistics() const {
+		common::println("frame set assembly of ", _sources.size(), " cameras: complete ", _statistics.complete.load(), ", incomplete ", _statistics.incomplete.load(), ", late ", _statistics.late.load(), ", duplicate ",
+		    _statistics.duplicate.load(), ", unknown ", _statistics.unknown.load());
+	}
+};
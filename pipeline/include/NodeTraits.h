@@ -0,0 +1,50 @@
+#pragma once
+
+#include <utility>
+
+#include "Processor.h"
+#include "Pusher.h"
+
+namespace detail {
+template <typename Input, typename Output>
+Input processor_input(Processor<Input, Output> const*);
+template <typename Input, typename Output>
+Output processor_output(Processor<Input, Output> const*);
+template <typename Output>
+Output pusher_output(Pusher<Output> const*);
+}  // namespace detail
+
+/**
+ * @brief True for nodes derived from Processor.
+ */
+template <typename Node>
+concept ProcessorNode = requires(Node const* node) { detail::processor_output(node); };
+
+/**
+ * @brief True for nodes derived from Pusher, i.e. nodes that create messages in their own thread.
+ */
+template <typename Node>
+concept PusherNode = requires(Node const* node) { detail::pusher_output(node); };
+
+/**
+ * @brief The input type of a Processor.
+ */
+template <ProcessorNode Node>
+using processor_input_t = decltype(detail::processor_input(std::declval<Node const*>()));
+
+/**
+ * @brief The type of the messages a Processor or Pusher hands to its successors.
+ */
+template <typename Node>
+struct node_output;
+template <ProcessorNode Node>
+struct node_output<Node> {
+	using type = decltype(detail::processor_output(std::declval<Node const*>()));
+};
+template <PusherNode Node>
+    requires(!ProcessorNode<Node>)
+struct node_output<Node> {
+	using type = decltype(detail::pusher_output(std::declval<Node const*>()));
+};
+template <typename Node>
+using node_output_t = typename node_output<Node>::type;
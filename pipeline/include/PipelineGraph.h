@@ -0,0 +1,281 @@
+#pragma once
+
+#include <functional>
+#include <map>
+#include <memory>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "NodeTraits.h"
+#include "RingBufferEdgeNode.h"
+#include "Runner.h"
+#include "ThreadPlacement.h"
+#include "common_output.h"
+
+/**
+ * @brief How an edge of the pipeline graph is executed.
+ */
+enum class Connection {
+	automatic,     ///< fused into the thread of the producer, unless the edge is a fan-out, a fan-in or leads into an isolated node
+	synchronous,   ///< always fused, e.g. for nodes that must run in the thread of their producer like ImageVisualizationNode
+	asynchronous,  ///< always a queue hop into a thread of its own
+};
+
+/**
+ * @class PipelineGraph
+ * @brief Builds the pipeline from the whole topology instead of hand-wired connect calls.
+ *
+ * Chains of single-input/single-output nodes are fused, i.e. they run inline one after another in the thread of the first node of the chain.
+ * Only fan-outs, fan-ins and declared isolation points get an asynchronous boundary, which is a lock-free RingBufferEdgeNode with a thread of its own.
+ * Nodes with their own input stage, like BoundedEdgeNode, RingBufferEdgeNode and ReplicatedProcessorNode, are connected via their input() and started with their own threads.
+ * @code
+ * PipelineGraph graph;
+ * graph.add("cams", cams);
+ * graph.add("down", down);
+ * graph.add("track", track, {.isolated = true});
+ * graph.connect(cams, down);
+ * graph.connect(down, track);
+ * auto pipeline = graph.start();
+ * @endcode
+ */
+class PipelineGraph {
+   public:
+	/**
+	 * @brief Options of a node in the graph.
+	 */
+	struct NodeOptions {
+		bool isolated = false;                           // the node always gets an asynchronous input, e.g. to decouple it from a slow or bursty producer
+		std::optional<ThreadPlacementConfig> placement;  // placement of the thread the node runs in, if it runs in a thread of its own
+	};
+
+	/**
+	 * @brief A started thread and how to ask it to stop without waiting for it.
+	 */
+	struct RunningThread {
+		std::shared_ptr<void> thread;
+		std::function<void()> request_stop;  // empty if the thread handle cannot be stopped without being joined
+	};
+
+	/**
+	 * @class RunningPipeline
+	 * @brief Owns the threads and the queues of a started pipeline.
+	 *
+	 * On destruction all threads are asked to stop, then the queues are closed, which wakes the threads waiting on them, and finally the threads are joined in the reverse order they were started.
+	 * The threads are asked to stop before the queues are closed, so that no thread hands the empty message of a closed queue downstream.
+	 */
+	class RunningPipeline {
+		std::vector<std::shared_ptr<void>> _edges;
+		std::vector<std::function<void()>> _close;
+		std::vector<RunningThread> _threads;
+
+	   public:
+		RunningPipeline(std::vector<std::shared_ptr<void>> edges, std::vector<std::function<void()>> close, std::vector<RunningThread> threads)
+		    : _edges(std::move(edges)), _close(std::move(close)), _threads(std::move(threads)) {}
+		RunningPipeline(RunningPipeline&&) = default;
+		RunningPipeline& operator=(RunningPipeline&&) = delete;
+
+		~RunningPipeline() {
+			for (auto const& thread : _threads) {
+				if (thread.request_stop) thread.request_stop();
+			}
+			for (auto const& close : _close) close();
+			while (!_threads.empty()) _threads.pop_back();
+		}
+	};
+
+   private:
+	struct NodeEntry {
+		std::string name;
+		NodeOptions options;
+		std::function<std::vector<RunningThread>(NodeEntry const&)> start;  // empty for nodes that run in the thread of their producer
+		std::function<void()> close;                                        // empty for nodes without queues of their own
+	};
+
+	struct EdgeEntry {
+		void const* from;
+		void const* to;
+		Connection connection;
+		std::function<void()> connect_synchronously;
+		std::function<void(PipelineGraph&, bool multiple_producers)> connect_asynchronously;
+	};
+
+	struct InputEdge {
+		std::shared_ptr<void> edge;
+		void* input;
+		std::function<RunningThread()> start;
+		std::function<void()> close;
+	};
+
+	std::size_t const _edge_capacity;
+	bool _started = false;
+
+	std::vector<void const*> _order;
+	std::map<void const*, NodeEntry> _nodes;
+	std::vector<EdgeEntry> _edges;
+	std::map<void const*, InputEdge> _input_edges;
+
+	/**
+	 * @brief Returns the node messages are handed to, i.e. the input stage for nodes that have one.
+	 */
+	template <typename Node>
+	static decltype(auto) target(Node& node) {
+		if constexpr (requires { node.input(); })
+			return node.input();
+		else
+			return (node);
+	}
+
+	template <typename Thread>
+	static RunningThread place(Thread&& thread, std::string const& name, std::optional<ThreadPlacementConfig> const& placement) {
+		auto ret = std::make_shared<std::remove_cvref_t<Thread>>(std::forward<Thread>(thread));
+		if constexpr (requires { ret->native_handle(); }) {
+			if (placement) place_thread(name, *ret, *placement);
+		}
+
+		std::function<void()> request_stop;
+		if constexpr (requires { ret->request_stop(); }) request_stop = [thread = ret.get()] { thread->request_stop(); };
+		return {ret, std::move(request_stop)};
+	}
+
+	/**
+	 * @brief Returns the asynchronous input of the consumer, creates it on first use.
+	 */
+	template <typename T, typename Consumer>
+	Runner<T>& input_edge(Consumer& consumer, bool const multiple_producers) {
+		auto& entry = _input_edges[&consumer];
+		if (!entry.edge) {
+			auto const& node = _nodes.at(&consumer);
+			auto const make = [&]<Producers producers>() {
+				auto edge = std::make_shared<RingBufferEdgeNode<T, producers>>(node.name + " input", _edge_capacity);
+				edge->synchronously_connect(target(consumer));
+
+				entry.input = &edge->input();
+				entry.start = [edge, name = node.name, placement = node.options.placement] { return place((*edge)(), name, placement); };
+				entry.close = [edge = edge.get()] { edge->close(); };
+				entry.edge = edge;
+			};
+
+			if (multiple_producers)
+				make.template operator()<Producers::multiple>();
+			else
+				make.template operator()<Producers::single>();
+		}
+
+		return *static_cast<Runner<T>*>(entry.input);
+	}
+
+	std::string const& name(void const* node) const { return _nodes.at(node).name; }
+
+   public:
+	/**
+	 * @param edge_capacity The capacity of the ring buffers at the asynchronous boundaries.
+	 */
+	explicit PipelineGraph(std::size_t const edge_capacity = 16) : _edge_capacity(edge_capacity) {}
+
+	/**
+	 * @brief Adds a node to the graph. The node must outlive the running pipeline.
+	 *
+	 * @param name The name of the node in the execution plan and the thread placement report.
+	 * @param node The node.
+	 * @param options Whether the node is an isolation point and where its thread should run.
+	 */
+	template <typename Node>
+	void add(std::string name, Node& node, NodeOptions options = {}) {
+		NodeEntry entry{std::move(name), std::move(options), {}, {}};
+
+		// processors run in the thread of their producer or of their asynchronous input, only sources need a thread of their own
+		if constexpr (PusherNode<Node> && !ProcessorNode<Node>) {
+			entry.start = [&node](NodeEntry const& self) {
+				std::vector<RunningThread> threads;
+				if constexpr (requires { node.workers(); }) {
+					auto workers = node.workers();
+					for (std::size_t i = 0; i < workers.size(); ++i) threads.push_back(place(std::move(workers[i]), self.name + " worker " + std::to_string(i), self.options.placement));
+				}
+				threads.push_back(place(node(), self.name, self.options.placement));
+				return threads;
+			};
+		}
+
+		// nodes with queues of their own, like BoundedEdgeNode and ReplicatedProcessorNode, are closed when the pipeline stops
+		if constexpr (requires { node.close(); }) entry.close = [&node] { node.close(); };
+
+		_nodes.emplace(&node, std::move(entry));
+		_order.push_back(&node);
+	}
+
+	/**
+	 * @brief Adds an edge from a Pusher or Processor to a node that accepts its output.
+	 *
+	 * @param from The producing node.
+	 * @param to The consuming node.
+	 * @param connection Whether the edge is fused, asynchronous or decided by the topology.
+	 */
+	template <typename From, typename To>
+	void connect(From& from, To& to, Connection const connection = Connection::automatic) {
+		if (!_nodes.contains(&from) || !_nodes.contains(&to)) common::println_critical_loc("Nodes must be added to the graph before they are connected!");
+
+		using T = node_output_t<From>;
+		_edges.push_back(EdgeEntry{&from, &to, connection, [&from, &to] { from.synchronously_connect(target(to)); },
+		    [&from, &to](PipelineGraph& graph, bool const multiple_producers) { from.synchronously_connect(graph.input_edge<T>(to, multiple_producers)); }});
+	}
+
+	/**
+	 * @brief Decides which edges are fused, connects all nodes, prints the execution plan and starts the threads.
+	 *
+	 * @return The running pipeline, it stops the threads when it is destroyed.
+	 */
+	[[nodiscard]] RunningPipeline start() {
+		if (_started) common::println_critical_loc("The pipeline graph was already started!");
+		_started = true;
+
+		std::map<void const*, int> out_degree, in_degree;
+		for (auto const& edge : _edges) {
+			++out_degree[edge.from];
+			++in_degree[edge.to];
+		}
+
+		std::vector<bool> asynchronous;
+		std::map<void const*, int> asynchronous_in_degree;
+		for (auto const& edge : _edges) {
+			bool const fan_out = out_degree[edge.from] > 1;
+			bool const fan_in = in_degree[edge.to] > 1;
+			asynchronous.push_back(edge.connection == Connection::asynchronous || (edge.connection == Connection::automatic && (fan_out || fan_in || _nodes.at(edge.to).options.isolated)));
+			if (asynchronous.back()) ++asynchronous_in_degree[edge.to];
+		}
+
+		common::println("pipeline execution plan:");
+		for (std::size_t i = 0; i < _edges.size(); ++i) {
+			auto const& edge = _edges[i];
+			if (asynchronous[i]) {
+				bool const multiple_producers = asynchronous_in_degree[edge.to] > 1;
+				edge.connect_asynchronously(*this, multiple_producers);
+				common::println("  ", name(edge.from), " -> ", name(edge.to), ": asynchronous (", multiple_producers ? "mpsc" : "spsc", " ring buffer)");
+			} else {
+				edge.connect_synchronously();
+				common::println("  ", name(edge.from), " -> ", name(edge.to), ": fused");
+			}
+		}
+
+		std::vector<std::shared_ptr<void>> edges;
+		std::vector<std::function<void()>> close;
+		std::vector<RunningThread> threads;
+
+		// consumers are started before their producers, so that no message has to wait for its consumer to come up
+		for (auto const& [node, input_edge] : _input_edges) {
+			edges.push_back(input_edge.edge);
+			close.push_back(input_edge.close);
+			threads.push_back(input_edge.start());
+		}
+		for (auto const node : _order) {
+			auto const& entry = _nodes.at(node);
+			if (entry.close) close.push_back(entry.close);
+			if (entry.start) {
+				for (auto& thread : entry.start(entry)) threads.push_back(std::move(thread));
+			}
+		}
+
+		return RunningPipeline(std::move(edges), std::move(close), std::move(threads));
+	}
+};
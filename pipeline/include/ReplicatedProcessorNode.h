@@ -0,0 +1,206 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <concepts>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <limits>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <stop_token>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "BoundedEdgeNode.h"
+#include "BoundedQueue.h"
+#include "NodeTraits.h"
+#include "Processor.h"
+#include "Pusher.h"
+#include "Runner.h"
+#include "Shared.h"
+#include "common_output.h"
+
+/**
+ * @class ReplicatedProcessorNode
+ * @brief Runs a stateless Processor with several replicas in parallel and restores the order of the results per source.
+ *
+ * Every replica has its own worker thread and a small blocking input queue. Incoming messages are handed to the replica with the fewest queued messages.
+ * The results are released in the order the messages arrived per source, so that stateful nodes like ImageTrackerNode downstream still see monotonic timestamps.
+ * The reorder stage relies on two things:
+ * - input() is called by one thread at a time, e.g. the thread of an edge in front of the node. Concurrent calls are detected and reported.
+ * - A replica returns exactly one result per message and handles its messages in order, which every Processor does.
+ * A message that is not accepted by the queue of its replica, e.g. because the node is stopped, is skipped in the order instead of holding back the later results.
+ * Stopping the thread of the node closes the output, stopping the worker threads closes the queues of the replicas.
+ * @code
+ * ReplicatedProcessorNode<YoloNode<480, 640>> yolo(4, [] { return YoloNode<480, 640>(camera_sizes(), model_path()); });
+ * down.synchronously_connect(yolo.input());
+ * yolo.synchronously_connect(track);
+ * auto yolo_workers = yolo.workers();
+ * auto yolo_thread = yolo();
+ * @endcode
+ *
+ * @tparam Node The Processor to be replicated. It must not keep state between messages.
+ */
+template <ProcessorNode Node>
+class ReplicatedProcessorNode : public Pusher<node_output_t<Node>> {
+	using Input = processor_input_t<Node>;
+	using Output = node_output_t<Node>;
+
+	/**
+	 * @brief Forwards the messages to the replica with the fewest queued messages and remembers their order per source.
+	 */
+	class Dispatcher : public Runner<Input> {
+		ReplicatedProcessorNode& _node;
+		std::size_t _next = 0;
+		std::atomic_flag _dispatching;
+
+	   public:
+		explicit Dispatcher(ReplicatedProcessorNode& node) : _node(node) {}
+
+		void run(Input const& data) final {
+			// the pending list of a replica must be in the order of its queue, which only holds if the messages are dispatched one at a time
+			if (_dispatching.test_and_set(std::memory_order_acquire)) common::println_critical_loc("The input of a ReplicatedProcessorNode must not be called from several threads at the same time!");
+
+			auto& workers = _node._workers;
+
+			std::size_t worker = _next;
+			SourceOrder* source;
+			std::uint64_t sequence;
+			{
+				std::scoped_lock lock(_node._order_mutex);
+
+				for (std::size_t i = 1; i < workers.size(); ++i) {
+					if (std::size_t const candidate = (_next + i) % workers.size(); workers[candidate]->size() < workers[worker]->size()) worker = candidate;
+				}
+				_next = (worker + 1) % workers.size();
+
+				source = &_node._sources[unwrap_message(data).source];
+				sequence = source->dispatched++;
+				_node._pending[worker].emplace_back(source, sequence);
+			}
+
+			if (!workers[worker]->enqueue(data)) {
+				std::scoped_lock lock(_node._order_mutex);
+
+				// the replica never sees the message, so its result must not be waited for
+				_node._pending[worker].pop_back();
+				source->finished.emplace(sequence, std::nullopt);
+				_node.release(*source);
+			}
+
+			_dispatching.clear(std::memory_order_release);
+		}
+	} _dispatcher;
+
+	/**
+	 * @brief Receives the results of one replica and hands them to the reorder stage.
+	 */
+	class Collector : public Runner<Output> {
+		ReplicatedProcessorNode& _node;
+		std::size_t const _worker;
+
+	   public:
+		Collector(ReplicatedProcessorNode& node, std::size_t const worker) : _node(node), _worker(worker) {}
+
+		void run(Output const& data) final { _node.reorder(_worker, data); }
+	};
+
+	struct SourceOrder {
+		std::uint64_t dispatched = 0;
+		std::uint64_t released = 0;
+		std::map<std::uint64_t, std::optional<Output>> finished;  // results waiting for their predecessors, std::nullopt for skipped messages
+	};
+
+	std::vector<std::unique_ptr<Node>> _replicas;
+	std::vector<std::unique_ptr<BoundedEdgeNode<Input>>> _workers;
+	std::vector<std::unique_ptr<Collector>> _collectors;
+
+	std::mutex _order_mutex;
+	std::map<std::string, SourceOrder> _sources;
+	std::vector<std::deque<std::pair<SourceOrder*, std::uint64_t>>> _pending;
+
+	BoundedQueue<Output> _output;
+	std::optional<std::stop_callback<std::function<void()>>> _close_on_stop;
+
+	/**
+	 * @brief Hands the finished results of the source downstream that have no unfinished predecessor. Must be called with the order mutex held.
+	 */
+	void release(SourceOrder& source) {
+		for (auto it = source.finished.begin(); it != source.finished.end() && it->first == source.released; it = source.finished.erase(it), ++source.released) {
+			if (it->second) _output.push(std::move(*it->second));
+		}
+	}
+
+	void reorder(std::size_t const worker, Output const& data) {
+		std::scoped_lock lock(_order_mutex);
+
+		// Every replica works off its queue in order and returns one result per message, so the front of its pending list belongs to this result.
+		auto const [source, sequence] = _pending[worker].front();
+		_pending[worker].pop_front();
+
+		source->finished.emplace(sequence, data);
+		release(*source);
+	}
+
+   public:
+	/**
+	 * @param replicas The number of replicas, each running in its own worker thread.
+	 * @param make_replica Returns a new replica by value, it is called once per replica.
+	 */
+	template <typename Factory>
+	    requires std::same_as<std::invoke_result_t<Factory&>, Node>
+	ReplicatedProcessorNode(std::size_t const replicas, Factory make_replica)
+	    : _dispatcher(*this), _pending(std::max<std::size_t>(replicas, 1)), _output(std::numeric_limits<std::size_t>::max(), OverflowPolicy::block) {
+		for (std::size_t i = 0; i < std::max<std::size_t>(replicas, 1); ++i) {
+			_replicas.emplace_back(new Node(make_replica()));
+			_workers.push_back(std::make_unique<BoundedEdgeNode<Input>>("replica " + std::to_string(i), 2, OverflowPolicy::block));
+			_collectors.push_back(std::make_unique<Collector>(*this, i));
+
+			_workers.back()->synchronously_connect(*_replicas.back());
+			_replicas.back()->synchronously_connect(*_collectors.back());
+		}
+	}
+
+	/**
+	 * @brief The node the producer is synchronously connected to.
+	 */
+	Runner<Input>& input() { return _dispatcher; }
+
+	/**
+	 * @brief Starts the worker threads of the replicas.
+	 * @return The thread handles, the workers run as long as they are alive.
+	 */
+	auto workers() {
+		std::vector<decltype(std::declval<BoundedEdgeNode<Input>&>()())> threads;
+		for (auto& worker : _workers) threads.push_back((*worker)());
+		return threads;
+	}
+
+	/**
+	 * @brief Hands the next result in per-source order downstream, waits until one is available.
+	 *
+	 * @return The result or an empty result once the node is stopped, like BoundedEdgeNode.
+	 */
+	Output push() final {
+		if (!_close_on_stop) _close_on_stop.emplace(this->stop_token, [this] { _output.close(); });
+
+		if (auto data = _output.pop()) return std::move(*data);
+		return Output{};
+	}
+
+	/**
+	 * @brief Closes the queues of the replicas and the output, so that no thread of the node keeps waiting.
+	 */
+	void close() {
+		for (auto& worker : _workers) worker->close();
+		_output.close();
+	}
+
+	[[nodiscard]] std::size_t replicas() const { return _replicas.size(); }
+};
@@ -0,0 +1,285 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <thread>
+#include <utility>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
+constexpr std::size_t cache_line_size = 64;
+
+/**
+ * @brief Tells the cpu that the thread is in a spin loop.
+ */
+inline void spin_pause() {
+#if defined(__x86_64__) || defined(__i386__)
+	_mm_pause();
+#elif defined(__aarch64__)
+	asm volatile("yield");
+#endif
+}
+
+/**
+ * @class AdaptiveWaiter
+ * @brief Lets one side of a ring buffer wait for the other side: first spins, then yields and finally sleeps on a futex via std::atomic::wait.
+ *
+ * The notifying side only issues a futex wake-up if a waiting side actually went to sleep.
+ */
+class AdaptiveWaiter {
+	alignas(cache_line_size) std::atomic<std::uint32_t> _signal = 0;
+	std::atomic<std::uint32_t> _sleeping = 0;
+
+	static constexpr int spins = 256;
+	static constexpr int yields = 16;
+
+   public:
+	/**
+	 * @brief Waits until ready() returns true.
+	 */
+	template <typename Ready>
+	void wait(Ready&& ready) {
+		for (int i = 0; i < spins; ++i) {
+			if (ready()) return;
+			spin_pause();
+		}
+		for (int i = 0; i < yields; ++i) {
+			if (ready()) return;
+			std::this_thread::yield();
+		}
+
+		_sleeping.fetch_add(1);
+		for (;;) {
+			auto const seen = _signal.load();
+			if (ready()) break;
+			_signal.wait(seen);
+		}
+		_sleeping.fetch_sub(1, std::memory_order_relaxed);
+	}
+
+	/**
+	 * @brief Wakes the waiting side, if it is sleeping.
+	 */
+	void notify() {
+		_signal.fetch_add(1);
+		if (_sleeping.load() > 0) _signal.notify_all();
+	}
+};
+
+/**
+ * @class SpscRingBuffer
+ * @brief A bounded, lock-free ring buffer for exactly one producer thread and one consumer thread.
+ *
+ * Head and tail live on separate cache lines and each side caches the index of the other side, so that the shared cache lines are only touched when the cached value is exhausted.
+ *
+ * @tparam T The element type.
+ */
+template <typename T>
+class SpscRingBuffer {
+	std::size_t const _mask;
+	std::unique_ptr<std::optional<T>[]> _slots;
+
+	alignas(cache_line_size) std::atomic<std::size_t> _head = 0;  // next slot to be read, written by the consumer
+	std::size_t _cached_tail = 0;
+
+	alignas(cache_line_size) std::atomic<std::size_t> _tail = 0;  // next slot to be written, written by the producer
+	std::size_t _cached_head = 0;
+
+	alignas(cache_line_size) AdaptiveWaiter _not_empty;
+	AdaptiveWaiter _not_full;
+	std::atomic<bool> _closed = false;
+
+   public:
+	/**
+	 * @param capacity The minimum number of elements, rounded up to the next power of two.
+	 */
+	explicit SpscRingBuffer(std::size_t const capacity) : _mask(std::bit_ceil(std::max<std::size_t>(capacity, 2)) - 1), _slots(std::make_unique<std::optional<T>[]>(_mask + 1)) {}
+
+	/**
+	 * @brief Enqueues an element, if there is room.
+	 * @return True, if the element was enqueued.
+	 */
+	template <typename U>
+	bool try_push(U&& data) {
+		std::size_t const tail = _tail.load(std::memory_order_relaxed);
+		if (tail - _cached_head > _mask) {
+			_cached_head = _head.load(std::memory_order_acquire);
+			if (tail - _cached_head > _mask) return false;
+		}
+
+		_slots[tail & _mask].emplace(std::forward<U>(data));
+		_tail.store(tail + 1, std::memory_order_release);
+		_not_empty.notify();
+		return true;
+	}
+
+	/**
+	 * @brief Dequeues an element, if there is one.
+	 */
+	std::optional<T> try_pop() {
+		std::size_t const head = _head.load(std::memory_order_relaxed);
+		if (head == _cached_tail) {
+			_cached_tail = _tail.load(std::memory_order_acquire);
+			if (head == _cached_tail) return std::nullopt;
+		}
+
+		auto& slot = _slots[head & _mask];
+		std::optional<T> ret = std::move(slot);
+		slot.reset();
+		_head.store(head + 1, std::memory_order_release);
+		_not_full.notify();
+		return ret;
+	}
+
+	/**
+	 * @brief Enqueues an element, waits adaptively until there is room.
+	 * @return True, if the element was enqueued, false if the ring buffer is closed.
+	 */
+	template <typename U>
+	bool push(U&& data) {
+		if (_closed.load(std::memory_order_acquire)) return false;
+		if (try_push(std::forward<U>(data))) return true;
+		_not_full.wait([this] { return _tail.load(std::memory_order_relaxed) - _head.load(std::memory_order_acquire) <= _mask || _closed.load(std::memory_order_acquire); });
+		return !_closed.load(std::memory_order_acquire) && try_push(std::forward<U>(data));
+	}
+
+	/**
+	 * @brief Dequeues an element, waits adaptively until there is one.
+	 * @return The element or std::nullopt if the ring buffer is closed and empty.
+	 */
+	std::optional<T> pop() {
+		std::optional<T> ret;
+		_not_empty.wait([this, &ret] { return (ret = try_pop()).has_value() || _closed.load(std::memory_order_acquire); });
+		return ret;
+	}
+
+	/**
+	 * @brief Closes the ring buffer and wakes both sides: push fails from now on, pop hands out the queued elements and then std::nullopt.
+	 */
+	void close() {
+		_closed.store(true, std::memory_order_release);
+		_not_empty.notify();
+		_not_full.notify();
+	}
+
+	[[nodiscard]] std::size_t size() const { return _tail.load(std::memory_order_acquire) - _head.load(std::memory_order_acquire); }
+	[[nodiscard]] std::size_t capacity() const { return _mask + 1; }
+};
+
+/**
+ * @class MpscRingBuffer
+ * @brief A bounded, lock-free ring buffer for several producer threads and one consumer thread, e.g. for the fan-in of several cameras into one node.
+ *
+ * Every slot carries a sequence number that tells producers and the consumer whether the slot is free or filled (Vyukov's bounded queue).
+ *
+ * @tparam T The element type.
+ */
+template <typename T>
+class MpscRingBuffer {
+	struct alignas(cache_line_size) Slot {
+		std::atomic<std::size_t> sequence;
+		std::optional<T> data;
+	};
+
+	std::size_t const _mask;
+	std::unique_ptr<Slot[]> _slots;
+
+	alignas(cache_line_size) std::atomic<std::size_t> _head = 0;  // next slot to be read, only used by the consumer
+	alignas(cache_line_size) std::atomic<std::size_t> _tail = 0;  // next slot to be claimed by a producer
+
+	alignas(cache_line_size) AdaptiveWaiter _not_empty;
+	AdaptiveWaiter _not_full;
+	std::atomic<bool> _closed = false;
+
+   public:
+	/**
+	 * @param capacity The minimum number of elements, rounded up to the next power of two.
+	 */
+	explicit MpscRingBuffer(std::size_t const capacity) : _mask(std::bit_ceil(std::max<std::size_t>(capacity, 2)) - 1), _slots(std::make_unique<Slot[]>(_mask + 1)) {
+		for (std::size_t i = 0; i <= _mask; ++i) _slots[i].sequence.store(i, std::memory_order_relaxed);
+	}
+
+	/**
+	 * @brief Enqueues an element, if there is room. Can be called from any number of threads.
+	 * @return True, if the element was enqueued.
+	 */
+	template <typename U>
+	bool try_push(U&& data) {
+		for (std::size_t tail = _tail.load(std::memory_order_relaxed);;) {
+			Slot& slot = _slots[tail & _mask];
+			std::size_t const sequence = slot.sequence.load(std::memory_order_acquire);
+
+			if (auto const difference = static_cast<std::ptrdiff_t>(sequence) - static_cast<std::ptrdiff_t>(tail); difference == 0) {
+				if (_tail.compare_exchange_weak(tail, tail + 1, std::memory_order_relaxed)) {
+					slot.data.emplace(std::forward<U>(data));
+					slot.sequence.store(tail + 1, std::memory_order_release);
+					_not_empty.notify();
+					return true;
+				}
+			} else if (difference < 0) {
+				return false;
+			} else {
+				tail = _tail.load(std::memory_order_relaxed);
+			}
+		}
+	}
+
+	/**
+	 * @brief Dequeues an element, if there is one. Must only be called from the consumer thread.
+	 */
+	std::optional<T> try_pop() {
+		std::size_t const head = _head.load(std::memory_order_relaxed);
+		Slot& slot = _slots[head & _mask];
+		if (slot.sequence.load(std::memory_order_acquire) != head + 1) return std::nullopt;
+
+		std::optional<T> ret = std::move(slot.data);
+		slot.data.reset();
+		slot.sequence.store(head + _mask + 1, std::memory_order_release);
+		_head.store(head + 1, std::memory_order_relaxed);
+		_not_full.notify();
+		return ret;
+	}
+
+	/**
+	 * @brief Enqueues an element, waits adaptively until there is room.
+	 * @return True, if the element was enqueued, false if the ring buffer is closed.
+	 */
+	template <typename U>
+	bool push(U&& data) {
+		if (_closed.load(std::memory_order_acquire)) return false;
+
+		// try_push only consumes the element if it succeeds, so it is safe to forward it repeatedly
+		bool pushed = false;
+		_not_full.wait([this, &data, &pushed] { return (pushed = try_push(std::forward<U>(data))) || _closed.load(std::memory_order_acquire); });
+		return pushed;
+	}
+
+	/**
+	 * @brief Dequeues an element, waits adaptively until there is one. Must only be called from the consumer thread.
+	 * @return The element or std::nullopt if the ring buffer is closed and empty.
+	 */
+	std::optional<T> pop() {
+		std::optional<T> ret;
+		_not_empty.wait([this, &ret] { return (ret = try_pop()).has_value() || _closed.load(std::memory_order_acquire); });
+		return ret;
+	}
+
+	/**
+	 * @brief Closes the ring buffer and wakes all sides: push fails from now on, pop hands out the queued elements and then std::nullopt.
+	 */
+	void close() {
+		_closed.store(true, std::memory_order_release);
+		_not_empty.notify();
+		_not_full.notify();
+	}
+
+	[[nodiscard]] std::size_t size() const { return _tail.load(std::memory_order_acquire) - _head.load(std::memory_order_acquire); }
+	[[nodiscard]] std::size_t capacity() const { return _mask + 1; }
+};
@@ -0,0 +1,89 @@
+#pragma once
+
+#include <functional>
+#include <optional>
+#include <stop_token>
+#include <string>
+#include <type_traits>
+#include <utility>
+
+#include "Pusher.h"
+#include "RingBuffer.h"
+#include "Runner.h"
+#include "common_output.h"
+
+/**
+ * @brief Describes how many threads feed an edge.
+ */
+enum class Producers {
+	single,   ///< exactly one producer thread, uses SpscRingBuffer
+	multiple  ///< several producer threads, e.g. a fan-in of several cameras, uses MpscRingBuffer
+};
+
+/**
+ * @class RingBufferEdgeNode
+ * @brief An asynchronous edge backed by a lock-free ring buffer. The consumer waits adaptively instead of sleeping on a condition variable.
+ *
+ * Wired like BoundedEdgeNode:
+ * @code
+ * RingBufferEdgeNode<ImageData, Producers::single> edge("cams->down", 16);
+ * cams.synchronously_connect(edge.input());
+ * edge.synchronously_connect(down);
+ * auto edge_thread = edge();
+ * @endcode
+ * The producer waits adaptively if the ring buffer is full.
+ * Stopping the thread of the edge closes the ring buffer, so that neither the edge nor a waiting producer keeps the thread from being joined.
+ *
+ * @tparam T The message type that is passed along the edge.
+ * @tparam producers Whether one or several threads push into the edge.
+ */
+template <typename T, Producers producers = Producers::single>
+class RingBufferEdgeNode : public Pusher<T> {
+	using Buffer = std::conditional_t<producers == Producers::single, SpscRingBuffer<T>, MpscRingBuffer<T>>;
+
+	std::string _name;
+	Buffer _buffer;
+
+	class Input : public Runner<T> {
+		Buffer& _buffer;
+
+	   public:
+		explicit Input(Buffer& buffer) : _buffer(buffer) {}
+		void run(T const& data) final { _buffer.push(data); }
+	} _input;
+
+	std::optional<std::stop_callback<std::function<void()>>> _close_on_stop;
+
+   public:
+	/**
+	 * @param name The name of the edge.
+	 * @param capacity The minimum number of queued messages, rounded up to the next power of two.
+	 */
+	RingBufferEdgeNode(std::string name, std::size_t const capacity) : _name(std::move(name)), _buffer(capacity), _input(_buffer) {}
+
+	/**
+	 * @brief The node the producer is synchronously connected to.
+	 */
+	Runner<T>& input() { return _input; }
+
+	/**
+	 * @brief Hands the oldest queued message to the consumer, waits adaptively until one is available.
+	 *
+	 * @return The message or an empty message once the edge is stopped, like BoundedEdgeNode.
+	 */
+	T push() final {
+		if (!_close_on_stop) _close_on_stop.emplace(this->stop_token, [this] { _buffer.close(); });
+
+		if (auto data = _buffer.pop()) return std::move(*data);
+		return T{};
+	}
+
+	/**
+	 * @brief Closes the edge: the producer can no longer enqueue and the consumer stops waiting.
+	 */
+	void close() { _buffer.close(); }
+
+	[[nodiscard]] std::string const& name() const { return _name; }
+	[[nodiscard]] std::size_t size() const { return _buffer.size(); }
+	[[nodiscard]] std::size_t capacity() const { return _buffer.capacity(); }
+};
@@ -0,0 +1,123 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <optional>
+#include <utility>
+#include <vector>
+
+#include "common_output.h"
+
+/**
+ * @class TimestampMerge
+ * @brief Merges the messages of several sources, each delivered in its own thread, into one stream in timestamp order.
+ *
+ * Every source has a small queue. If a queue is full, its oldest message is evicted, so that a merge that falls behind still hands on the latest messages.
+ * The oldest queued message is released as soon as no other source can deliver an older one, i.e. every other source has a message queued or already delivered a newer one.
+ * A message waits at most the merge window for lagging sources, after that it is released regardless.
+ *
+ * @tparam T The message type, it must have a timestamp member.
+ */
+template <typename T>
+class TimestampMerge {
+	struct Queued {
+		T data;
+		std::chrono::steady_clock::time_point arrival;
+	};
+
+	struct Source {
+		std::deque<Queued> queued;
+		std::uint64_t last_merged_timestamp = 0;
+	};
+
+	std::size_t const _capacity;
+	std::chrono::nanoseconds const _window;
+
+	std::mutex _mutex;
+	std::condition_variable _changed;
+	std::vector<Source> _sources;
+	bool _closed = false;
+
+   public:
+	/**
+	 * @param sources The number of sources, they are addressed by their index.
+	 * @param capacity The maximum number of queued messages per source, at least 1.
+	 * @param window How long a message waits at most for older messages of lagging sources.
+	 */
+	TimestampMerge(std::size_t const sources, std::size_t const capacity, std::chrono::nanoseconds const window) : _capacity(std::max<std::size_t>(capacity, 1)), _window(window), _sources(sources) {
+		if (!sources) common::println_critical_loc("A timestamp merge needs at least one source!");
+	}
+
+	/**
+	 * @brief Queues a message of the source. Must only be called from the thread of the source.
+	 *
+	 * @return True, if the message was queued without evicting an older one.
+	 */
+	bool push(std::size_t const source, T data) {
+		bool evicted = false;
+		{
+			std::scoped_lock lock(_mutex);
+			auto& queued = _sources.at(source).queued;
+			if (queued.size() >= _capacity) {
+				queued.pop_front();
+				evicted = true;
+			}
+			queued.push_back(Queued{std::move(data), std::chrono::steady_clock::now()});
+		}
+		_changed.notify_one();
+
+		return !evicted;
+	}
+
+	/**
+	 * @brief Hands on the next message in timestamp order, waits until one can be released.
+	 *
+	 * @return The message or std::nullopt once the merge is closed.
+	 */
+	std::optional<T> pop() {
+		std::unique_lock lock(_mutex);
+		while (!_closed) {
+			Source* oldest = nullptr;
+			for (auto& source : _sources) {
+				if (!source.queued.empty() && (!oldest || source.queued.front().data.timestamp < oldest->queued.front().data.timestamp)) oldest = &source;
+			}
+
+			if (!oldest) {
+				_changed.wait(lock);
+				continue;
+			}
+
+			auto const timestamp = oldest->queued.front().data.timestamp;
+			auto const deadline = oldest->queued.front().arrival + _window;
+
+			// a source without a queued message can only deliver messages newer than the last one merged from it
+			bool const ordered = std::ranges::all_of(_sources, [timestamp](Source const& source) { return !source.queued.empty() || source.last_merged_timestamp >= timestamp; });
+			if (ordered || std::chrono::steady_clock::now() >= deadline) {
+				oldest->last_merged_timestamp = timestamp;
+
+				std::optional<T> ret(std::move(oldest->queued.front().data));
+				oldest->queued.pop_front();
+				return ret;
+			}
+
+			_changed.wait_until(lock, deadline);
+		}
+
+		return std::nullopt;
+	}
+
+	/**
+	 * @brief Closes the merge and wakes the waiting consumer, e.g. to stop its thread.
+	 */
+	void close() {
+		{
+			std::scoped_lock lock(_mutex);
+			_closed = true;
+		}
+		_changed.notify_all();
+	}
+};
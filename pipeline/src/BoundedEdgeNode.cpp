@@ -0,0 +1 @@
+#include "BoundedEdgeNode.h"
\ No newline at end of file
@@ -0,0 +1 @@
+#include "FrameSetAssemblyNode.h"
\ No newline at end of file
@@ -0,0 +1 @@
+#include "PipelineGraph.h"
\ No newline at end of file
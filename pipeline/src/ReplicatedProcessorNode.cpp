@@ -0,0 +1 @@
+#include "ReplicatedProcessorNode.h"
\ No newline at end of file
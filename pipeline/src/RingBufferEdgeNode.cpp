@@ -0,0 +1 @@
+#include "RingBufferEdgeNode.h"
\ No newline at end of file
@@ -0,0 +1 @@
+#include "TimestampMerge.h"
\ No newline at end of file
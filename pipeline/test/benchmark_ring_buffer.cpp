@@ -0,0 +1,109 @@
+#include <chrono>
+#include <cstdint>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "BoundedQueue.h"
+#include "LatencyTracer.h"
+#include "RingBuffer.h"
+#include "common_output.h"
+
+using namespace std::chrono_literals;
+
+static std::uint64_t now() { return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count(); }
+
+/**
+ * @brief Measures the latency of one hop, i.e. from push in the producer thread until pop returns in the consumer thread.
+ *
+ * The producers send a message every 50 us, so that the consumer is idle in between like a node waiting for the next frame.
+ */
+template <typename Queue>
+void benchmark_hop_latency(std::string_view const name, Queue& queue, int const producers, int const messages_per_producer) {
+	LatencyHistogram histogram;
+
+	std::thread consumer([&] {
+		for (int i = 0; i < producers * messages_per_producer; ++i) {
+			std::uint64_t const sent = *queue.pop();
+			histogram.record(now() - sent);
+		}
+	});
+
+	std::vector<std::thread> producer_threads;
+	for (int p = 0; p < producers; ++p) {
+		producer_threads.emplace_back([&] {
+			for (int i = 0; i < messages_per_producer; ++i) {
+				queue.push(now());
+				for (auto const next = now() + 50'000; now() < next;) std::this_thread::yield();
+			}
+		});
+	}
+
+	for (auto& producer : producer_threads) producer.join();
+	consumer.join();
+
+	common::println(name, " hop latency: p50 ", histogram.percentile(0.5) / 1000., " us, p99 ", histogram.percentile(0.99) / 1000., " us, max ", histogram.max() / 1000., " us");
+}
+
+/**
+ * @brief Measures how many messages per second pass through the queue if the producers push as fast as possible.
+ */
+template <typename Queue>
+void benchmark_throughput(std::string_view const name, Queue& queue, int const producers, int const messages_per_producer) {
+	auto const t0 = std::chrono::steady_clock::now();
+
+	std::thread consumer([&] {
+		for (int i = 0; i < producers * messages_per_producer; ++i) queue.pop();
+	});
+
+	std::vector<std::thread> producer_threads;
+	for (int p = 0; p < producers; ++p) {
+		producer_threads.emplace_back([&] {
+			for (int i = 0; i < messages_per_producer; ++i) queue.push(std::uint64_t{0});
+		});
+	}
+
+	for (auto& producer : producer_threads) producer.join();
+	consumer.join();
+
+	auto const seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+	common::println(name, " throughput: ", static_cast<double>(producers * messages_per_producer) / seconds / 1e6, " million messages/s");
+}
+
+int main() {
+	constexpr int latency_messages = 20'000;
+	constexpr int throughput_messages = 2'000'000;
+
+	{
+		BoundedQueue<std::uint64_t> mutex_queue(1024, OverflowPolicy::block);
+		SpscRingBuffer<std::uint64_t> spsc(1024);
+		MpscRingBuffer<std::uint64_t> mpsc(1024);
+
+		benchmark_hop_latency("mutex queue 1 producer", mutex_queue, 1, latency_messages);
+		benchmark_hop_latency("spsc ring buffer 1 producer", spsc, 1, latency_messages);
+		benchmark_hop_latency("mpsc ring buffer 1 producer", mpsc, 1, latency_messages);
+	}
+	{
+		BoundedQueue<std::uint64_t> mutex_queue(1024, OverflowPolicy::block);
+		MpscRingBuffer<std::uint64_t> mpsc(1024);
+
+		benchmark_hop_latency("mutex queue 4 producers", mutex_queue, 4, latency_messages / 4);
+		benchmark_hop_latency("mpsc ring buffer 4 producers", mpsc, 4, latency_messages / 4);
+	}
+	{
+		BoundedQueue<std::uint64_t> mutex_queue(1024, OverflowPolicy::block);
+		SpscRingBuffer<std::uint64_t> spsc(1024);
+		MpscRingBuffer<std::uint64_t> mpsc(1024);
+
+		benchmark_throughput("mutex queue 1 producer", mutex_queue, 1, throughput_messages);
+		benchmark_throughput("spsc ring buffer 1 producer", spsc, 1, throughput_messages);
+		benchmark_throughput("mpsc ring buffer 1 producer", mpsc, 1, throughput_messages);
+	}
+	{
+		BoundedQueue<std::uint64_t> mutex_queue(1024, OverflowPolicy::block);
+		MpscRingBuffer<std::uint64_t> mpsc(1024);
+
+		benchmark_throughput("mutex queue 4 producers", mutex_queue, 4, throughput_messages / 4);
+		benchmark_throughput("mpsc ring buffer 4 producers", mpsc, 4, throughput_messages / 4);
+	}
+}
@@ -0,0 +1,428 @@
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <map>
+#include <optional>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "BoundedEdgeNode.h"
+#include "BoundedQueue.h"
+#include "FrameSetAssemblyNode.h"
+#include "ImageData.h"
+#include "PipelineGraph.h"
+#include "Processor.h"
+#include "Pusher.h"
+#include "ReplicatedProcessorNode.h"
+#include "RingBuffer.h"
+#include "RingBufferEdgeNode.h"
+#include "Runner.h"
+#include "TimestampMerge.h"
+#include "common_output.h"
+
+using namespace std::chrono_literals;
+
+/**
+ * @brief Emits small images of four cameras at 400 Hz in total, much faster than the consumer can handle.
+ */
+class FastCamerasNode : public Pusher<ImageData> {
+	std::uint64_t _count = 0;
+	std::array<std::string, 4> const _sources = {"s110_n_cam_8", "s110_o_cam_8", "s110_s_cam_8", "s110_w_cam_8"};
+
+	ImageData push() final {
+		std::this_thread::sleep_for(2500us);
+		std::uint64_t const now = std::chrono::time_point_cast<std::chrono::nanoseconds>(std::chrono::system_clock::now()).time_since_epoch().count();
+		return ImageData{cv::Mat(48, 64, CV_8UC3, cv::Scalar(static_cast<double>(_count % 255))), now, _sources[_count++ % _sources.size()]};
+	}
+};
+
+/**
+ * @brief Simulates a slow inference and prints how old the frames are that still arrive.
+ */
+class SlowInferenceNode : public Runner<ImageData> {
+	std::string _name;
+
+   public:
+	explicit SlowInferenceNode(std::string name) : _name(std::move(name)) {}
+
+	void run(ImageData const& data) final {
+		std::this_thread::sleep_for(20ms);
+		std::uint64_t const now = std::chrono::time_point_cast<std::chrono::nanoseconds>(std::chrono::system_clock::now()).time_since_epoch().count();
+		common::println(_name, ": ", data.source, " is ", (now - data.timestamp) / 1'000'000, " ms old");
+	}
+};
+
+/**
+ * @brief A stateless node whose processing time varies, so that the replicas finish out of order.
+ */
+class JitteryProcessingNode : public Processor<ImageData, ImageData> {
+	std::mt19937 _generator{std::random_device{}()};
+
+	ImageData process(ImageData const& data) final {
+		std::this_thread::sleep_for(std::chrono::microseconds(std::uniform_int_distribution<int>(1'000, 30'000)(_generator)));
+		return data;
+	}
+};
+
+/**
+ * @brief Remembers the thread it runs in, so that the fusion of the pipeline graph can be checked.
+ */
+class ThreadRecordingNode : public Processor<ImageData, ImageData> {
+   public:
+	std::atomic<std::thread::id> thread;
+
+	ImageData process(ImageData const& data) final {
+		thread = std::this_thread::get_id();
+		return data;
+	}
+};
+
+/**
+ * @brief Checks that the timestamps per source are strictly increasing.
+ */
+class OrderCheckNode : public Runner<ImageData> {
+	std::map<std::string, std::uint64_t> _last_timestamp;
+
+   public:
+	std::atomic<std::uint64_t> received = 0;
+	std::atomic<std::thread::id> thread;
+
+	void run(ImageData const& data) final {
+		thread = std::this_thread::get_id();
+
+		if (auto& last_timestamp = _last_timestamp[data.source]; data.timestamp <= last_timestamp)
+			common::println_critical_loc("Message of ", data.source, " with timestamp ", data.timestamp, " arrived after ", last_timestamp, '!');
+		else
+			last_timestamp = data.timestamp;
+
+		++received;
+	}
+};
+
+/**
+ * @brief Simulates four hardware-triggered cameras at 30 Hz: the timestamps jitter around the trigger pulse, the frames of one pulse arrive in random order, some frames are lost and some arrive late.
+ */
+class JitteredTriggerCamerasNode : public Pusher<ImageData> {
+	std::array<std::string, 4> const _sources = {"s110_n_cam_8", "s110_o_cam_8", "s110_s_cam_8", "s110_w_cam_8"};
+	std::mt19937 _generator{42};
+	std::vector<ImageData> _pulse;
+	std::optional<ImageData> _held_back;
+	int _pulses_held = 0;
+
+	void trigger() {
+		std::this_thread::sleep_for(33ms);
+		std::uint64_t const pulse = std::chrono::time_point_cast<std::chrono::nanoseconds>(std::chrono::system_clock::now()).time_since_epoch().count();
+
+		std::normal_distribution<double> jitter(0., 300'000.);
+		std::uniform_real_distribution<double> chance(0., 1.);
+		for (auto const& source : _sources) {
+			ImageData data{cv::Mat(48, 64, CV_8UC3), pulse + static_cast<std::uint64_t>(std::clamp(jitter(_generator), -900'000., 900'000.) + 1'000'000.), source};
+
+			if (double const p = chance(_generator); p < 0.03) {
+				continue;
+			} else if (p < 0.05 && !_held_back) {
+				_held_back = std::move(data);
+				_pulses_held = 0;
+			} else {
+				_pulse.push_back(std::move(data));
+			}
+		}
+		std::ranges::shuffle(_pulse, _generator);
+
+		// a held back frame arrives two pulses later, after its set timed out
+		if (_held_back && _pulses_held++ == 2) {
+			_pulse.push_back(std::move(*_held_back));
+			_held_back.reset();
+		}
+	}
+
+	ImageData push() final {
+		while (_pulse.empty()) trigger();
+
+		ImageData data = std::move(_pulse.back());
+		_pulse.pop_back();
+		return data;
+	}
+};
+
+/**
+ * @brief Checks that the frame sets are ordered and only contain frames of one trigger pulse.
+ */
+class FrameSetCheckNode : public Runner<FrameSet<ImageData>> {
+	std::uint64_t _last_timestamp = 0;
+
+   public:
+	std::atomic<std::uint64_t> received = 0;
+
+	void run(FrameSet<ImageData> const& set) final {
+		if (set.timestamp <= _last_timestamp) common::println_critical_loc("Frame set with timestamp ", set.timestamp, " arrived after ", _last_timestamp, '!');
+		_last_timestamp = set.timestamp;
+
+		if (set.frames.size() + set.missing.size() != 4) common::println_critical_loc("Frame set does not account for every camera!");
+		for (auto const& frame : set.frames) {
+			if (frame.timestamp - set.timestamp > 2'000'000) common::println_critical_loc("Frame of ", frame.source, " is ", frame.timestamp - set.timestamp, " ns away from its set!");
+		}
+
+		++received;
+	}
+};
+
+int main() {
+	{
+		BoundedQueue<int> closing(1, OverflowPolicy::block);
+		closing.push(1);
+
+		std::atomic<bool> pushed = true;
+		std::thread producer([&closing, &pushed] { pushed = closing.push(2); });
+		std::this_thread::sleep_for(100ms);
+		closing.close();
+		producer.join();
+
+		if (pushed) common::println_critical_loc("Blocked producer could enqueue into a closed queue!");
+		if (closing.pop() != 1 || closing.pop()) common::println_critical_loc("Closed queue did not hand out its queued element and then an empty result!");
+	}
+
+	{
+		MpscRingBuffer<int> closing(2);
+
+		std::optional<int> popped = 0;
+		std::thread consumer([&closing, &popped] { popped = closing.pop(); });
+		std::this_thread::sleep_for(100ms);
+		closing.close();
+		consumer.join();
+
+		if (popped) common::println_critical_loc("Waiting consumer was not woken up by closing the ring buffer!");
+		if (closing.push(1)) common::println_critical_loc("Producer could enqueue into a closed ring buffer!");
+	}
+
+	{
+		struct Stamped {
+			std::uint64_t timestamp;
+		};
+		TimestampMerge<Stamped> merge(3, 2, 20ms);
+
+		// every source has a message queued, so the merge releases them in timestamp order without waiting
+		merge.push(1, {20});
+		merge.push(0, {10});
+		merge.push(2, {15});
+		for (std::uint64_t const expected : {10, 15, 20}) {
+			if (merge.pop()->timestamp != expected) common::println_critical_loc("Timestamp merge did not release the messages in timestamp order!");
+		}
+
+		// the other sources already delivered newer messages or none, so the message waits for the merge window
+		auto const start = std::chrono::steady_clock::now();
+		merge.push(0, {30});
+		if (merge.pop()->timestamp != 30 || std::chrono::steady_clock::now() - start < 20ms) common::println_critical_loc("Timestamp merge did not wait for the lagging sources!");
+
+		// a full queue evicts its oldest message, so the latest ones are handed on
+		bool const evicted = merge.push(0, {40}) && merge.push(0, {50}) && !merge.push(0, {60});
+		merge.push(1, {70});
+		merge.push(2, {70});
+		if (!evicted || merge.pop()->timestamp != 50 || merge.pop()->timestamp != 60) common::println_critical_loc("Timestamp merge did not evict the oldest message of a full queue!");
+
+		merge.close();
+		if (merge.pop()) common::println_critical_loc("Closed timestamp merge handed on a message!");
+	}
+
+	FastCamerasNode cams;
+
+	BoundedEdgeNode<ImageData> block("block", 4, OverflowPolicy::block);
+	BoundedEdgeNode<ImageData> drop_oldest("drop_oldest", 4, OverflowPolicy::drop_oldest);
+	BoundedEdgeNode<ImageData> drop_newest("drop_newest", 4, OverflowPolicy::drop_newest);
+	BoundedEdgeNode<ImageData> latest_per_source("latest_per_source", 4, OverflowPolicy::latest_per_source);
+
+	SlowInferenceNode slow_drop_oldest("drop_oldest");
+	SlowInferenceNode slow_drop_newest("drop_newest");
+	SlowInferenceNode slow_latest_per_source("latest_per_source");
+
+	cams.synchronously_connect(drop_oldest.input());
+	cams.synchronously_connect(drop_newest.input());
+	cams.synchronously_connect(latest_per_source.input());
+
+	drop_oldest.synchronously_connect(slow_drop_oldest);
+	drop_newest.synchronously_connect(slow_drop_newest);
+	latest_per_source.synchronously_connect(slow_latest_per_source);
+
+	{
+		auto cams_thread = cams();
+		auto drop_oldest_thread = drop_oldest();
+		auto drop_newest_thread = drop_newest();
+		auto latest_per_source_thread = latest_per_source();
+
+		std::this_thread::sleep_for(5s);
+
+		drop_oldest.print_statistics();
+		drop_newest.print_statistics();
+		latest_per_source.print_statistics();
+
+		if (drop_oldest.statistics().high_water > 4 || drop_newest.statistics().high_water > 4 || latest_per_source.statistics().high_water > 4) common::println_critical_loc("Bounded edge grew beyond its capacity!");
+		if (latest_per_source.statistics().dropped == 0) common::println_critical_loc("Slow consumer did not lead to dropped frames!");
+	}
+
+	{
+		FastCamerasNode replicated_cams;
+		BoundedEdgeNode<ImageData> cams_to_processing("cams->processing", 8, OverflowPolicy::block);
+		ReplicatedProcessorNode<JitteryProcessingNode> processing(8, [] { return JitteryProcessingNode(); });
+		OrderCheckNode check;
+
+		replicated_cams.synchronously_connect(cams_to_processing.input());
+		cams_to_processing.synchronously_connect(processing.input());
+		processing.synchronously_connect(check);
+
+		auto replicated_cams_thread = replicated_cams();
+		auto cams_to_processing_thread = cams_to_processing();
+		auto processing_workers = processing.workers();
+		auto processing_thread = processing();
+
+		std::this_thread::sleep_for(3s);
+
+		common::println("replicated processing with ", processing.replicas(), " replicas received ", check.received.load(), " messages in order");
+		if (check.received == 0) common::println_critical_loc("Replicated processing did not output anything!");
+	}
+
+	{
+		ReplicatedProcessorNode<JitteryProcessingNode> closed(2, [] { return JitteryProcessingNode(); });
+		closed.close();
+
+		// the replicas do not run, so without skipping the messages the closed queues reject the dispatch would block after four messages
+		for (std::uint64_t i = 1; i <= 8; ++i) closed.input().run(ImageData{cv::Mat(), i, "s110_n_cam_8"});
+		common::println("closed replicated processing skipped all messages");
+	}
+
+	{
+		FastCamerasNode ring_cams;
+		RingBufferEdgeNode<ImageData, Producers::single> ring("cams->check", 16);
+		OrderCheckNode check;
+
+		ring_cams.synchronously_connect(ring.input());
+		ring.synchronously_connect(check);
+
+		auto ring_cams_thread = ring_cams();
+		auto ring_thread = ring();
+
+		std::this_thread::sleep_for(1s);
+
+		common::println("ring buffer edge received ", check.received.load(), " messages in order");
+		if (check.received == 0) common::println_critical_loc("Ring buffer edge did not output anything!");
+	}
+
+	{
+		FastCamerasNode graph_cams;
+		ThreadRecordingNode pre;
+		ThreadRecordingNode down;
+		OrderCheckNode check_a;
+		OrderCheckNode check_b;
+
+		PipelineGraph graph;
+		graph.add("cams", graph_cams);
+		graph.add("pre", pre);
+		graph.add("down", down);
+		graph.add("check a", check_a);
+		graph.add("check b", check_b);
+
+		graph.connect(graph_cams, pre);
+		graph.connect(pre, down);
+		graph.connect(down, check_a);
+		graph.connect(down, check_b);
+
+		auto pipeline = graph.start();
+
+		std::this_thread::sleep_for(1s);
+
+		common::println("pipeline graph received ", check_a.received.load(), " and ", check_b.received.load(), " messages in order");
+		if (check_a.received == 0 || check_b.received == 0) common::println_critical_loc("Pipeline graph did not output anything!");
+		if (pre.thread.load() != down.thread.load()) common::println_critical_loc("Fused chain did not run in one thread!");
+		if (check_a.thread.load() == down.thread.load() || check_b.thread.load() == down.thread.load() || check_a.thread.load() == check_b.thread.load()) common::println_critical_loc("Fan-out was not asynchronous!");
+	}
+
+	{
+		FastCamerasNode best_effort_cams;
+		OrderCheckNode check;
+		BoundedEdgeNode<ImageData> cams_to_slow("cams->slow", 1, OverflowPolicy::drop_oldest);
+		SlowInferenceNode slow("best effort");
+
+		// a best effort branch like the visualization sits behind an edge that keeps only the latest message, so it cannot hold back the other branch
+		PipelineGraph graph(1);
+		graph.add("cams", best_effort_cams);
+		graph.add("check", check);
+		graph.add("cams->slow", cams_to_slow, {.isolated = false, .placement = ThreadPlacementConfig{.cpus = {}, .policy = SchedulingPolicy::idle}});
+		graph.add("slow", slow);
+
+		graph.connect(best_effort_cams, check);
+		graph.connect(best_effort_cams, cams_to_slow, Connection::synchronous);
+		graph.connect(cams_to_slow, slow);
+
+		auto pipeline = graph.start();
+
+		std::this_thread::sleep_for(1s);
+
+		cams_to_slow.print_statistics();
+		if (check.received < 200) common::println_critical_loc("Slow best effort branch held back the pipeline, only ", check.received.load(), " messages arrived!");
+	}
+
+	{
+		FastCamerasNode blocked_cams;
+		SlowInferenceNode slow_block("block");
+
+		blocked_cams.synchronously_connect(block.input());
+		block.synchronously_connect(slow_block);
+
+		auto blocked_cams_thread = blocked_cams();
+		auto block_thread = block();
+
+		std::this_thread::sleep_for(2s);
+
+		block.print_statistics();
+
+		if (block.statistics().dropped != 0) common::println_critical_loc("Blocking edge dropped frames!");
+	}
+
+	{
+		FrameSetAssemblyNode<ImageData> closing({"s110_n_cam_8", "s110_o_cam_8"}, 2ms, 1h);
+		closing.input().run(ImageData{cv::Mat(), 1'000'000, "s110_n_cam_8"});
+		closing.close();
+		closing.input().run(ImageData{cv::Mat(), 1'000'000, "s110_o_cam_8"});
+
+		// the pending set is handed on without waiting for its timeout, the frame added after closing is rejected
+		auto const pending = closing.push();
+		if (pending.frames.size() != 1 || pending.missing != std::vector<std::string>{"s110_o_cam_8"}) common::println_critical_loc("Closed frame set assembly did not hand on its pending set!");
+		if (!closing.push().frames.empty()) common::println_critical_loc("Closed frame set assembly did not return an empty set!");
+	}
+
+	{
+		// no producer is connected, so only stopping the thread can wake the waiting consumer
+		FrameSetAssemblyNode<ImageData> stopping({"s110_n_cam_8", "s110_o_cam_8"}, 2ms, 20ms);
+		auto stopping_thread = stopping();
+		std::this_thread::sleep_for(100ms);
+
+		auto const start = std::chrono::steady_clock::now();
+		stopping_thread.request_stop();
+		stopping_thread.join();
+		if (std::chrono::steady_clock::now() - start > 1s) common::println_critical_loc("Stopping did not wake the waiting frame set assembly!");
+		common::println("stopped frame set assembly joined");
+	}
+
+	{
+		JitteredTriggerCamerasNode trigger_cams;
+		FrameSetAssemblyNode<ImageData> assembly({"s110_n_cam_8", "s110_o_cam_8", "s110_s_cam_8", "s110_w_cam_8"}, 2ms, 20ms);
+		FrameSetCheckNode check;
+
+		trigger_cams.synchronously_connect(assembly.input());
+		assembly.synchronously_connect(check);
+
+		auto trigger_cams_thread = trigger_cams();
+		auto assembly_thread = assembly();
+
+		std::this_thread::sleep_for(3s);
+
+		assembly.print_statistics();
+
+		auto const& statistics = assembly.statistics();
+		if (statistics.complete == 0) common::println_critical_loc("Frame set assembly did not output complete sets!");
+		if (statistics.incomplete == 0 || statistics.late == 0) common::println_critical_loc("Lost and late frames were not detected!");
+		if (statistics.duplicate != 0 || statistics.unknown != 0) common::println_critical_loc("Frames of one pulse were not matched!");
+	}
+}
\ No newline at end of file
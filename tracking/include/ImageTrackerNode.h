@@ -4,7 +4,10 @@
 #include <chrono>
 
 #include "KalmanBoxSourceTrack.h"
+#include "LatencyTracer.h"
 #include "Processor.h"
+#include "Shared.h"
+#include "Trace.h"
 #include "association_functions.h"
 #include "linear_assignment.h"
 
@@ -14,6 +17,7 @@ struct ImageTrackerResults {
 	std::uint64_t timestamp;                    // UTC timestamp since epoch in ns
 	std::string source;                         // sensor source of detections
 	std::vector<KalmanBoxSourceTrack> objects;  // vector of tracks
+	Trace trace;                                // latency trace of the nodes the tracks passed through
 };
 
 /**
@@ -22,7 +26,7 @@ struct ImageTrackerResults {
  * @tparam max_age The maximum age of tracks before they are removed.
  */
 template <std::uint64_t max_age = std::chrono::duration_cast<std::chrono::nanoseconds>(700ms).count()>
-class ImageTrackerNode : public Processor<Detections2D, ImageTrackerResults> {
+class ImageTrackerNode : public Processor<Detections2D, Shared<ImageTrackerResults>> {
 	std::map<std::string, std::vector<KalmanBoxSourceTrack>> multiple_cameras_tracks;
 
    public:
@@ -30,8 +34,15 @@ class ImageTrackerNode : public Processor<Detections2D, ImageTrackerResults> {
 
 	/**
 	 * @brief Does one iteration of the sort tracking algorithm.
+	 *
+	 * Coasting detections of frames the detector skipped are empty, so the tracks are only predicted to the timestamp of the frame.
+	 *
+	 * @return The current tracks of the source. They are wrapped in a Shared envelope, so fanning them out to several consumers does not copy the tracks.
 	 */
-	ImageTrackerResults process(Detections2D const& data) override {
+	Shared<ImageTrackerResults> process(Detections2D const& data) override {
+		static auto& stage = latency_stage("track");
+		TraceScope scope(stage, data.trace);
+
 		auto& tracks = multiple_cameras_tracks[data.source];
 
 		// Deletes tracks which were updated > max age ago.
@@ -78,7 +89,8 @@ class ImageTrackerNode : public Processor<Detections2D, ImageTrackerResults> {
 		ret.source = data.source;
 		ret.timestamp = data.timestamp;
 		ret.objects = tracks;
+		ret.trace = scope.finish(ret.timestamp);
 
-		return ret;
+		return make_shared_message(std::move(ret));
 	}
 };
\ No newline at end of file
@@ -6,7 +6,9 @@
 
 #include "CompactObject.h"
 #include "ImageTrackerNode.h"
+#include "LatencyTracer.h"
 #include "Processor.h"
+#include "Shared.h"
 #include "common_literals.h"
 
 /**
@@ -15,7 +17,7 @@
  *
  * @attention not a true track-to-track fusion algorithm, as it does not map the tracks of the different cameras.
  */
-class TrackToTrackFusionNode : public Processor<ImageTrackerResults, CompactObjects> {
+class TrackToTrackFusionNode : public Processor<Shared<ImageTrackerResults>, Shared<CompactObjects>> {
 	struct TransformationConfig {
 		Eigen::Matrix<double, 3, 4> projection_matrix;
 		Eigen::Matrix<double, 4, 4> affine_transformation_base_to_utm;
@@ -77,18 +79,22 @@ class TrackToTrackFusionNode : public Processor<ImageTrackerResults, CompactObje
 	 * @brief Predicts the states of the unupdated tracks for the current time and converts the positions of both the unupdated and updated tracks to the UTM coordinate system.
 	 *
 	 * @param data The result of an image tracker.
-	 * @return Returns a list of the positions of the tracked objects.
+	 * @return Returns a list of the positions of the tracked objects, shared between all consumers of this node.
 	 */
-	CompactObjects process(ImageTrackerResults const& data) final {
-		multiple_tracker_results[data.source] = data.objects;
+	Shared<CompactObjects> process(Shared<ImageTrackerResults> const& data) final {
+		static auto& stage = latency_stage("fusion");
+		TraceScope scope(stage, data->trace);
+
+		// copy, because the tracks of the other sources are predicted in place
+		multiple_tracker_results[data->source] = data->objects;
 
 		CompactObjects ret;
-		ret.timestamp = data.timestamp;
+		ret.timestamp = data->timestamp;
 		for (auto& [cam_name, results] : multiple_tracker_results) {
-			if (cam_name != data.source) {
+			if (cam_name != data->source) {
 				for (auto& object : results) {
 					try {
-						object.predict(data.timestamp);
+						object.predict(data->timestamp);
 					} catch (common::Exception const& e) {
 						common::println_warn_loc(e.what());
 					}
@@ -108,6 +114,7 @@ class TrackToTrackFusionNode : public Processor<ImageTrackerResults, CompactObje
 			}
 		}
 
-		return ret;
+		ret.trace = scope.finish(ret.timestamp);
+		return make_shared_message(std::move(ret));
 	}
 };
\ No newline at end of file
@@ -0,0 +1,106 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+
+#include "ImageDownscalingNode.h"
+#include "ImageTrackerNode.h"
+#include "LatencyTracer.h"
+#include "MotionGateNode.h"
+#include "SyntheticScene.h"
+#include "association_functions.h"
+#include "common_output.h"
+#include "config.h"
+
+using namespace std::chrono_literals;
+
+static std::uint64_t now() { return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count(); }
+
+/**
+ * @brief Runs the synthetic scene through downscaling, the motion gate and the tracker, with the ground truth boxes as a perfect detector.
+ *
+ * The saved cpu is the share of frames on which the detector is skipped, the gate itself costs the printed time per frame.
+ * The tracking quality is measured against the ground truth of every frame, so the frames on which the tracks only coast count as well.
+ *
+ * @param gate The configuration of the motion gate, std::nullopt runs the detector on every frame.
+ */
+void benchmark_motion_gating(std::string_view const name, std::shared_ptr<SyntheticScene const> const& scene, std::optional<MotionGateConfig> const& gate, double const fps, std::chrono::seconds const duration) {
+	ImageDownscalingNode<480, 640, DownscalingOutput::chw_float> down;
+	MotionGateNode motion(gate.value_or(MotionGateConfig{}));
+	ImageTrackerNode track;
+	auto& down_processor = static_cast<Processor<ImageData, ImageData>&>(down);
+	auto& motion_processor = static_cast<Processor<ImageData, ImageData>&>(motion);
+	auto& track_processor = static_cast<Processor<Detections2D, Shared<ImageTrackerResults>>&>(track);
+
+	LatencyHistogram gate_histogram;
+	std::uint64_t frames = 0;
+	std::uint64_t detected = 0;
+	std::uint64_t ground_truth = 0;
+	std::uint64_t found = 0;
+	double iou_sum = 0.;
+
+	std::map<std::string, cv::Mat> images;
+	auto const period = static_cast<std::uint64_t>(1e9 / fps);
+	// the scene is a function of the timestamp, so all runs start at the same time to see the same traffic
+	constexpr std::uint64_t start = 1'720'000'000'000'000'000;
+	for (std::uint64_t timestamp = start; timestamp < start + std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count(); timestamp += period) {
+		for (auto const& [camera, camera_config] : scene->cameras()) {
+			scene->render(camera, timestamp, images[camera]);
+			ImageData image = down_processor.process(ImageData{images[camera], timestamp, camera, {}});
+
+			if (gate) {
+				std::uint64_t const gate_start = now();
+				image = motion_processor.process(image);
+				gate_histogram.record(now() - gate_start);
+			}
+
+			Detections2D const truth = scene->detections(camera, timestamp);
+			Detections2D detections{timestamp, camera, {}, {}};
+			if (image.skip_detection) {
+				detections.coasting = true;
+			} else {
+				detections.objects = truth.objects;
+				++detected;
+			}
+			++frames;
+
+			auto const tracks = track_processor.process(detections);
+			for (auto const& object : truth.objects) {
+				double best = 0.;
+				for (auto const& track : tracks->objects) best = std::max(best, iou(track.state(), object.bbox));
+
+				++ground_truth;
+				if (best >= 0.5) ++found;
+				iou_sum += best;
+			}
+		}
+	}
+
+	common::println(name, ": detector on ", detected, '/', frames, " frames (", 100. * (frames - detected) / frames, " % saved), gate p50 ", gate ? gate_histogram.percentile(0.5) / 1e6 : 0., " ms, recall@0.5 ",
+	    ground_truth ? static_cast<double>(found) / ground_truth : 1., ", mean iou ", ground_truth ? iou_sum / ground_truth : 1.);
+}
+
+int main() {
+	constexpr double fps = 10.;
+	constexpr auto duration = 60s;
+
+	std::map<std::string, SyntheticCameraConfig> const cameras = {{"s110_n_cam_8", {config::projection_matrix_s110_base_north_into_s110_n_cam_8, config::height_s110_n_cam_8, config::width_s110_n_cam_8}},
+	    {"s110_o_cam_8", {config::projection_matrix_s110_base_north_into_s110_o_cam_8, config::height_s110_o_cam_8, config::width_s110_o_cam_8}},
+	    {"s110_s_cam_8", {config::projection_matrix_s110_base_north_into_s110_s_cam_8, config::height_s110_s_cam_8, config::width_s110_s_cam_8}},
+	    {"s110_w_cam_8", {config::projection_matrix_s110_base_north_into_s110_w_cam_8, config::height_s110_w_cam_8, config::width_s110_w_cam_8}}};
+
+	// few objects leave cameras without traffic, which is where the gate saves most
+	for (std::size_t const objects : {2, 6, 20}) {
+		auto const scene = std::make_shared<SyntheticScene const>(cameras, SyntheticSceneConfig{.objects = objects, .seed = 0});
+		std::string const prefix = std::to_string(objects) + " objects, ";
+
+		benchmark_motion_gating(prefix + "no gate", scene, std::nullopt, fps, duration);
+		benchmark_motion_gating(prefix + "gate 300 ms", scene, MotionGateConfig{}, fps, duration);
+		benchmark_motion_gating(prefix + "gate 600 ms", scene, MotionGateConfig{.max_skip_interval = 600ms}, fps, duration);
+		benchmark_motion_gating(prefix + "coarse gate 600 ms", scene, MotionGateConfig{.pixel_threshold = 12.f, .changed_fraction = 0.02, .subsampling = 4, .max_skip_interval = 600ms}, fps, duration);
+	}
+}
@@ -14,18 +14,18 @@
 
 using namespace std::chrono_literals;
 
-class ImageTrackerResultsVisualization : public ProcessorSynchronousPair<ImageData, ImageTrackerResults, ImageData> {
+class ImageTrackerResultsVisualization : public ProcessorSynchronousPair<ImageData, Shared<ImageTrackerResults>, ImageData> {
    public:
 	ImageTrackerResultsVisualization()
-	    : ProcessorSynchronousPair<ImageData, ImageTrackerResults, ImageData>([](ImageData const& data1, ImageTrackerResults const& data2) {
-		      if (data1.source != data2.source) return false;
-		      if (data1.timestamp != data2.timestamp) return false;
+	    : ProcessorSynchronousPair<ImageData, Shared<ImageTrackerResults>, ImageData>([](ImageData const& data1, Shared<ImageTrackerResults> const& data2) {
+		      if (data1.source != data2->source) return false;
+		      if (data1.timestamp != data2->timestamp) return false;
 
 		      return true;
 	      }) {}
 
-	ImageData process(ImageData const& data1, ImageTrackerResults const& data2) final {
-		for (auto const object : data2.objects) {
+	ImageData process(ImageData const& data1, Shared<ImageTrackerResults> const& data2) final {
+		for (auto const& object : data2->objects) {
 			cv::rectangle(data1.image, cv::Point2d(object.state().left, object.state().top), cv::Point2d(object.state().right, object.state().bottom), cv::Scalar_<int>(0, 0, 255), 5);
 			cv::putText(data1.image, std::to_string(object.id()), cv::Point2d(object.state().left, object.state().top), cv::FONT_HERSHEY_DUPLEX, 1.0, cv::Scalar_<int>(0, 0, 0), 1);
 		}
@@ -57,7 +57,7 @@ int main(int argc, char** argv) {
 		        {"s110_o_cam_8", std::filesystem::path(CMAKE_SOURCE_DIR) / "data" / "tumtraf_v2x_cooperative_perception_dataset" / "val" / "images" / "s110_camera_basler_east_8mm"},
 		        {"s110_w_cam_8", std::filesystem::path(CMAKE_SOURCE_DIR) / "data" / "tumtraf_v2x_cooperative_perception_dataset" / "val" / "images" / "s110_camera_basler_south1_8mm"},
 		        {"s110_s_cam_8", std::filesystem::path(CMAKE_SOURCE_DIR) / "data" / "tumtraf_v2x_cooperative_perception_dataset" / "val" / "images" / "s110_camera_basler_south2_8mm"}});
-		ImageDownscalingNode<480, 640> down;
+		ImageDownscalingNode<480, 640, DownscalingOutput::chw_float> down;
 		YoloNode<480, 640> yolo(
 		    {{"s110_n_cam_8", {1200, 1920}}, {"s110_s_cam_8", {1200, 1920}}, {"s110_o_cam_8", {1200, 1920}}, {"s110_w_cam_8", {1200, 1920}}}, std::filesystem::path(CMAKE_SOURCE_DIR) / "data" / "yolo" / "480x640" / "yolo11m.torchscript");
 		ImageTrackerNode track;
@@ -66,7 +66,7 @@ int main(int argc, char** argv) {
 		    {"s110_s_cam_8", {config::projection_matrix_s110_base_north_into_s110_s_cam_8, config::affine_transformation_utm_to_s110_base_north}},
 		    {"s110_w_cam_8", {config::projection_matrix_s110_base_north_into_s110_w_cam_8, config::affine_transformation_utm_to_s110_base_north}}});
 
-		BirdEyeVisualizationNode<CompactObjects> vis(map, utm_to_image);
+		BirdEyeVisualizationNode<Shared<CompactObjects>> vis(map, utm_to_image);
 		ImageVisualizationNode img([](ImageData const& data) { return data.source == "bird"; });
 
 		cams.asynchronously_connect(down);
@@ -99,7 +99,7 @@ int main(int argc, char** argv) {
 		        {"s110_o_cam_8", std::filesystem::path(CMAKE_SOURCE_DIR) / "data" / "tumtraf_v2x_cooperative_perception_dataset" / "val" / "images" / "s110_camera_basler_east_8mm"},
 		        {"s110_w_cam_8", std::filesystem::path(CMAKE_SOURCE_DIR) / "data" / "tumtraf_v2x_cooperative_perception_dataset" / "val" / "images" / "s110_camera_basler_south1_8mm"},
 		        {"s110_s_cam_8", std::filesystem::path(CMAKE_SOURCE_DIR) / "data" / "tumtraf_v2x_cooperative_perception_dataset" / "val" / "images" / "s110_camera_basler_south2_8mm"}});
-		ImageDownscalingNode<480, 640> down;
+		ImageDownscalingNode<480, 640, DownscalingOutput::chw_float> down;
 		YoloNode<480, 640> yolo(
 		    {{"s110_n_cam_8", {1200, 1920}}, {"s110_s_cam_8", {1200, 1920}}, {"s110_o_cam_8", {1200, 1920}}, {"s110_w_cam_8", {1200, 1920}}}, std::filesystem::path(CMAKE_SOURCE_DIR) / "data" / "yolo" / "480x640" / "yolo11m.torchscript");
 		ImageTrackerNode track;
@@ -0,0 +1,109 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <string_view>
+
+#include "Trace.h"
+
+/**
+ * @class LatencyHistogram
+ * @brief A lock-free histogram of durations in ns with logarithmic buckets (8 buckets per power of two, so at most 12.5% relative error).
+ */
+class LatencyHistogram {
+	static constexpr std::size_t sub_buckets = 8;
+	static constexpr std::size_t bucket_count = 64 * sub_buckets;
+
+	std::array<std::atomic<std::uint64_t>, bucket_count> _buckets{};
+	std::atomic<std::uint64_t> _count = 0;
+	std::atomic<std::uint64_t> _sum = 0;
+	std::atomic<std::uint64_t> _max = 0;
+
+	static std::size_t bucket(std::uint64_t value);
+	static std::uint64_t bucket_upper_bound(std::size_t bucket);
+
+   public:
+	/**
+	 * @brief Adds a duration to the histogram, can be called from any thread.
+	 * @param value The duration in ns.
+	 */
+	void record(std::uint64_t value);
+
+	/**
+	 * @brief Returns the duration in ns below which the given fraction of the recorded durations lie.
+	 * @param quantile The fraction, e.g. 0.99 for the p99.
+	 */
+	[[nodiscard]] std::uint64_t percentile(double quantile) const;
+
+	[[nodiscard]] std::uint64_t count() const { return _count.load(std::memory_order_relaxed); }
+	[[nodiscard]] std::uint64_t max() const { return _max.load(std::memory_order_relaxed); }
+	[[nodiscard]] double mean() const;
+};
+
+/**
+ * @brief The latency histograms of one node.
+ */
+struct LatencyStage {
+	std::string_view name;
+	LatencyHistogram processing;     // exit - enter
+	LatencyHistogram queue_wait;     // enter - exit of the previous node
+	LatencyHistogram since_capture;  // exit - timestamp of the message
+};
+
+/**
+ * @brief Returns the latency histograms of the node with the given name, creates them on first use.
+ *
+ * Nodes look up their stage once, e.g. `static auto& stage = latency_stage("yolo");`.
+ *
+ * @param name The name of the node, must refer to static storage.
+ */
+LatencyStage& latency_stage(std::string_view name);
+
+/**
+ * @brief Prints count, p50 and p99 of all stages in ms.
+ */
+void print_latency_statistics();
+
+/**
+ * @brief Writes count, p50, p99 and max of all stages in ns as csv.
+ */
+void write_latency_statistics(std::filesystem::path const& file);
+
+/**
+ * @class TraceScope
+ * @brief Measures one pass of a message through a node and appends it to the trace of the message.
+ *
+ * @code
+ * static auto& stage = latency_stage("down");
+ * TraceScope scope(stage, data.trace);
+ * ...
+ * ret.trace = scope.finish(ret.timestamp);
+ * @endcode
+ */
+class TraceScope {
+	LatencyStage& _stage;
+	Trace const* const _input;
+	std::uint64_t const _enter;
+
+   public:
+	/**
+	 * @brief Starts a new trace, used by nodes that create messages.
+	 */
+	explicit TraceScope(LatencyStage& stage);
+
+	/**
+	 * @brief Continues the trace of the incoming message.
+	 * @param input The trace of the incoming message, must outlive this scope.
+	 */
+	TraceScope(LatencyStage& stage, Trace const& input);
+
+	/**
+	 * @brief Records the pass in the histograms of the stage.
+	 * @param timestamp The timestamp of the message, used for the latency since capture.
+	 * @return The trace of the incoming message with this pass appended.
+	 */
+	Trace finish(std::uint64_t timestamp);
+};
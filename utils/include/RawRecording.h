@@ -0,0 +1,129 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "RawBuffer.h"
+
+/**
+ * @brief One frame in the index of a raw recording.
+ *
+ * A recording is a folder with the preallocated segment files segment_<n>.bin holding the frames back to back,
+ * the index index.bin with a header followed by one entry per frame, and sources.txt with one source name per line.
+ */
+struct RawRecordingEntry {
+	std::uint64_t arrived;   // timestamp when the frame arrived in ns
+	std::uint64_t recorded;  // timestamp of the frame in ns
+	std::uint64_t offset;    // offset of the frame in the segment
+	std::uint64_t length;    // size of the frame in bytes
+	std::uint32_t segment;   // number of the segment file
+	std::uint32_t source;    // line of the source name in sources.txt
+};
+static_assert(sizeof(RawRecordingEntry) == 40);
+
+/**
+ * @class RawRecordingWriter
+ * @brief Appends raw frames to a segmented recording with sequential, buffered writes.
+ *
+ * Index entries are only written after the frame they point to, so that an interrupted recording can still be read up to the last complete frame.
+ */
+class RawRecordingWriter {
+	std::filesystem::path const _folder;
+	std::uint64_t const _segment_size;
+
+	int _segment_fd = -1;
+	std::uint32_t _segment = 0;
+	std::uint64_t _segment_used = 0;      // bytes of the segment that belong to frames, including the buffered ones
+	std::uint64_t _segment_capacity = 0;  // preallocated bytes of the segment
+
+	std::vector<std::uint8_t> _buffer;
+	std::size_t _buffered = 0;
+
+	std::ofstream _index;
+	std::ofstream _sources;
+	std::map<std::string, std::uint32_t> _source_ids;
+	std::vector<RawRecordingEntry> _pending_entries;
+	std::uint64_t _frames = 0;
+
+	void write_buffer();
+	void open_segment(std::uint64_t minimum_size);
+	void close_segment();
+
+   public:
+	/**
+	 * @param folder The folder of the recording, is created if it does not exist. An existing recording is replaced.
+	 * @param segment_size The size segment files are preallocated with.
+	 * @param buffer_size The size of the write buffer.
+	 */
+	explicit RawRecordingWriter(std::filesystem::path folder, std::uint64_t segment_size = std::uint64_t{1} << 30, std::size_t buffer_size = std::size_t{8} << 20);
+	~RawRecordingWriter();
+
+	RawRecordingWriter(RawRecordingWriter const&) = delete;
+	RawRecordingWriter& operator=(RawRecordingWriter const&) = delete;
+
+	/**
+	 * @brief Appends a frame.
+	 *
+	 * @param source The camera the frame belongs to.
+	 * @param arrived The timestamp when the frame arrived in ns.
+	 * @param recorded The timestamp of the frame in ns.
+	 * @param data The frame.
+	 */
+	void append(std::string const& source, std::uint64_t arrived, std::uint64_t recorded, RawBuffer const& data);
+
+	/**
+	 * @brief Writes the buffered frames and their index entries.
+	 */
+	void flush();
+
+	[[nodiscard]] std::uint64_t frames() const { return _frames; }
+};
+
+/**
+ * @class RawRecordingReader
+ * @brief Maps a segmented recording into memory and hands out its frames as views without copying.
+ */
+class RawRecordingReader {
+	struct MappedSegment;
+
+	std::vector<std::shared_ptr<MappedSegment const>> _segments;
+	std::vector<RawRecordingEntry> _entries;
+	std::vector<std::string> _sources;
+
+   public:
+	/**
+	 * @param folder The folder of the recording.
+	 */
+	explicit RawRecordingReader(std::filesystem::path const& folder);
+
+	/**
+	 * @return The number of frames.
+	 */
+	[[nodiscard]] std::size_t size() const { return _entries.size(); }
+
+	/**
+	 * @return The index entry of the i-th frame in the order of arrival.
+	 */
+	[[nodiscard]] RawRecordingEntry const& entry(std::size_t i) const { return _entries[i]; }
+
+	/**
+	 * @return The source name of the entry.
+	 */
+	[[nodiscard]] std::string const& source(RawRecordingEntry const& entry) const { return _sources[entry.source]; }
+
+	/**
+	 * @return The i-th frame as view into the mapped segment, the segment stays mapped as long as the view exists.
+	 */
+	[[nodiscard]] RawBuffer frame(std::size_t i) const;
+
+	/**
+	 * @brief Tells the kernel that the i-th frame is needed soon, so that it is read from disk in the background.
+	 */
+	void prefetch(std::size_t i) const;
+};
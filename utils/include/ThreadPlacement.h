@@ -0,0 +1,60 @@
+#pragma once
+
+#include <pthread.h>
+
+#include <string>
+#include <vector>
+
+/**
+ * @brief The linux scheduling classes a node thread can run in.
+ */
+enum class SchedulingPolicy {
+	other,        ///< SCHED_OTHER, the default time-sharing class
+	batch,        ///< SCHED_BATCH, time-sharing for cpu-bound work that is not latency sensitive
+	idle,         ///< SCHED_IDLE, only runs when nothing else wants the cpu, e.g. for visualization
+	fifo,         ///< SCHED_FIFO, real-time without time slices, e.g. for camera grabbing
+	round_robin,  ///< SCHED_RR, real-time with time slices
+};
+
+/**
+ * @brief Describes where and how a node thread should be scheduled.
+ */
+struct ThreadPlacementConfig {
+	std::vector<int> cpus;                             // cores the thread may run on, empty keeps the inherited affinity
+	SchedulingPolicy policy = SchedulingPolicy::other;  // scheduling class
+	int priority = 0;                                   // real-time priority for fifo and round_robin (1 to 99), ignored otherwise
+	int nice = 0;                                       // nice value for other and batch, only applied by place_this_thread
+};
+
+/**
+ * @brief Applies the placement to a thread and remembers it for the placement report.
+ *
+ * Failures, e.g. missing CAP_SYS_NICE for real-time priorities, are reported as warnings and do not stop the pipeline.
+ *
+ * @param name The name of the thread in the report.
+ * @param thread The native handle of the thread.
+ * @param config The requested placement.
+ * @return True, if everything was applied.
+ */
+bool place_thread(std::string const& name, pthread_t thread, ThreadPlacementConfig const& config);
+
+/**
+ * @brief Applies the placement to a thread object returned by the call operator of a node.
+ */
+template <typename Thread>
+    requires requires(Thread& thread) { thread.native_handle(); }
+bool place_thread(std::string const& name, Thread& thread, ThreadPlacementConfig const& config) {
+	return place_thread(name, thread.native_handle(), config);
+}
+
+/**
+ * @brief Applies the placement to the calling thread, including the nice value.
+ */
+bool place_this_thread(std::string const& name, ThreadPlacementConfig const& config);
+
+/**
+ * @brief Prints the requested and the effective placement of all placed threads, read back from the kernel.
+ *
+ * @attention Must be called while the placed threads are still running.
+ */
+void print_thread_placement_report();
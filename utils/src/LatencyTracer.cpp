@@ -0,0 +1,119 @@
+#include "LatencyTracer.h"
+
+#include <bit>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <mutex>
+
+#include "common_output.h"
+
+static std::uint64_t now() { return std::chrono::time_point_cast<std::chrono::nanoseconds>(std::chrono::system_clock::now()).time_since_epoch().count(); }
+
+std::size_t LatencyHistogram::bucket(std::uint64_t const value) {
+	if (value < sub_buckets) return value;
+
+	auto const msb = static_cast<std::size_t>(std::bit_width(value) - 1);
+	return (msb - 2) * sub_buckets + ((value >> (msb - 3)) & (sub_buckets - 1));
+}
+
+std::uint64_t LatencyHistogram::bucket_upper_bound(std::size_t const bucket) {
+	if (bucket < sub_buckets) return bucket;
+
+	std::size_t const msb = bucket / sub_buckets + 2;
+	std::uint64_t const lower = (sub_buckets + bucket % sub_buckets) << (msb - 3);
+	return lower + ((1ull << (msb - 3)) - 1);
+}
+
+void LatencyHistogram::record(std::uint64_t const value) {
+	_buckets[bucket(value)].fetch_add(1, std::memory_order_relaxed);
+	_count.fetch_add(1, std::memory_order_relaxed);
+	_sum.fetch_add(value, std::memory_order_relaxed);
+	for (auto max = _max.load(std::memory_order_relaxed); max < value && !_max.compare_exchange_weak(max, value, std::memory_order_relaxed);) {
+	}
+}
+
+std::uint64_t LatencyHistogram::percentile(double const quantile) const {
+	std::uint64_t const count = _count.load(std::memory_order_relaxed);
+	if (count == 0) return 0;
+
+	auto const rank = static_cast<std::uint64_t>(std::max(1., quantile * static_cast<double>(count) + 0.5));
+	std::uint64_t seen = 0;
+	for (std::size_t i = 0; i < bucket_count; ++i) {
+		seen += _buckets[i].load(std::memory_order_relaxed);
+		if (seen >= rank) return std::min(bucket_upper_bound(i), max());
+	}
+
+	return max();
+}
+
+double LatencyHistogram::mean() const {
+	std::uint64_t const count = _count.load(std::memory_order_relaxed);
+	return count ? static_cast<double>(_sum.load(std::memory_order_relaxed)) / static_cast<double>(count) : 0.;
+}
+
+static std::mutex latency_stages_mutex;
+static std::map<std::string_view, std::unique_ptr<LatencyStage>, std::less<>> latency_stages;
+
+LatencyStage& latency_stage(std::string_view const name) {
+	std::scoped_lock lock(latency_stages_mutex);
+
+	auto& stage = latency_stages[name];
+	if (!stage) {
+		stage = std::make_unique<LatencyStage>();
+		stage->name = name;
+	}
+
+	return *stage;
+}
+
+void print_latency_statistics() {
+	std::scoped_lock lock(latency_stages_mutex);
+
+	auto const ms = [](std::uint64_t const ns) { return static_cast<double>(ns) / 1'000'000.; };
+	for (auto const& [name, stage] : latency_stages) {
+		common::println(name, ": ", stage->processing.count(), " messages, processing p50 ", ms(stage->processing.percentile(0.5)), " ms, p99 ", ms(stage->processing.percentile(0.99)), " ms, queue wait p50 ",
+		    ms(stage->queue_wait.percentile(0.5)), " ms, p99 ", ms(stage->queue_wait.percentile(0.99)), " ms, since capture p50 ", ms(stage->since_capture.percentile(0.5)), " ms, p99 ", ms(stage->since_capture.percentile(0.99)),
+		    " ms");
+	}
+}
+
+void write_latency_statistics(std::filesystem::path const& file) {
+	std::scoped_lock lock(latency_stages_mutex);
+
+	std::ofstream out(file);
+	if (!out.is_open()) {
+		common::println_error_loc("Could not open '", file.string(), "'!");
+		return;
+	}
+
+	out << "stage,histogram,count,p50,p99,max" << std::endl;
+	for (auto const& [name, stage] : latency_stages) {
+		for (auto const& [histogram_name, histogram] :
+		    {std::pair<char const*, LatencyHistogram const*>{"processing", &stage->processing}, {"queue_wait", &stage->queue_wait}, {"since_capture", &stage->since_capture}}) {
+			out << name << ',' << histogram_name << ',' << histogram->count() << ',' << histogram->percentile(0.5) << ',' << histogram->percentile(0.99) << ',' << histogram->max() << std::endl;
+		}
+	}
+}
+
+TraceScope::TraceScope(LatencyStage& stage) : _stage(stage), _input(nullptr), _enter(now()) {}
+
+TraceScope::TraceScope(LatencyStage& stage, Trace const& input) : _stage(stage), _input(&input), _enter(now()) {}
+
+Trace TraceScope::finish(std::uint64_t const timestamp) {
+	std::uint64_t const exit = now();
+	std::uint64_t const queue_wait = _input && !_input->spans.empty() && _enter > _input->spans.back().exit ? _enter - _input->spans.back().exit : 0;
+
+	_stage.processing.record(exit - _enter);
+	_stage.queue_wait.record(queue_wait);
+	if (exit > timestamp) _stage.since_capture.record(exit - timestamp);
+
+	Trace ret;
+	if (_input) {
+		ret.spans.reserve(_input->spans.size() + 1);
+		ret.spans = _input->spans;
+	}
+	ret.spans.push_back(TraceSpan{_stage.name, _enter, exit, queue_wait});
+
+	return ret;
+}
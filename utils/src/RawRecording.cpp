@@ -0,0 +1,196 @@
+#include "RawRecording.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <cstring>
+
+#include "common_output.h"
+
+static constexpr std::array<char, 8> index_magic = {'R', 'A', 'W', 'R', 'E', 'C', '\0', '\0'};
+static constexpr std::uint32_t index_version = 1;
+
+struct RawRecordingIndexHeader {
+	std::array<char, 8> magic;
+	std::uint32_t version;
+	std::uint32_t entry_size;
+};
+
+static std::filesystem::path segment_path(std::filesystem::path const& folder, std::uint32_t const segment) {
+	std::string number = std::to_string(segment);
+	if (number.size() < 6) number.insert(0, 6 - number.size(), '0');
+	return folder / ("segment_" + number + ".bin");
+}
+
+static void write_all(int const fd, std::uint8_t const* data, std::size_t size) {
+	while (size) {
+		ssize_t const written = ::write(fd, data, size);
+		if (written < 0) {
+			if (errno == EINTR) continue;
+			common::println_critical_loc("Could not write to the raw recording: ", std::strerror(errno), '!');
+		}
+		data += written;
+		size -= static_cast<std::size_t>(written);
+	}
+}
+
+RawRecordingWriter::RawRecordingWriter(std::filesystem::path folder, std::uint64_t const segment_size, std::size_t const buffer_size)
+    : _folder(std::move(folder)), _segment_size(segment_size), _buffer(buffer_size) {
+	std::filesystem::create_directories(_folder);
+	for (std::uint32_t segment = 0; std::filesystem::remove(segment_path(_folder, segment)); ++segment);
+
+	_index.open(_folder / "index.bin", std::ios::binary | std::ios::trunc);
+	_sources.open(_folder / "sources.txt", std::ios::trunc);
+	if (!_index || !_sources) common::println_critical_loc("Could not create the raw recording in ", _folder, '!');
+
+	RawRecordingIndexHeader const header{index_magic, index_version, sizeof(RawRecordingEntry)};
+	_index.write(reinterpret_cast<char const*>(&header), sizeof(header));
+}
+
+RawRecordingWriter::~RawRecordingWriter() {
+	if (_segment_fd >= 0) close_segment();
+	flush();
+}
+
+/**
+ * @brief Writes the buffered frames to the segment and afterwards the index entries that point to them.
+ */
+void RawRecordingWriter::write_buffer() {
+	if (_buffered) write_all(_segment_fd, _buffer.data(), _buffered);
+	_buffered = 0;
+
+	_index.write(reinterpret_cast<char const*>(_pending_entries.data()), static_cast<std::streamsize>(_pending_entries.size() * sizeof(RawRecordingEntry)));
+	_pending_entries.clear();
+}
+
+void RawRecordingWriter::open_segment(std::uint64_t const minimum_size) {
+	_segment_fd = ::open(segment_path(_folder, _segment).c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+	if (_segment_fd < 0) common::println_critical_loc("Could not create segment ", segment_path(_folder, _segment), ": ", std::strerror(errno), '!');
+
+	_segment_used = 0;
+	_segment_capacity = std::max(_segment_size, minimum_size);
+
+	// preallocating keeps the segment contiguous on disk, the unused rest is cut off when the segment is closed
+	if (int const error = ::posix_fallocate(_segment_fd, 0, static_cast<off_t>(_segment_capacity)); error)
+		common::println_warn_loc("Could not preallocate segment ", segment_path(_folder, _segment), ": ", std::strerror(error), '!');
+}
+
+void RawRecordingWriter::close_segment() {
+	write_buffer();
+
+	if (::ftruncate(_segment_fd, static_cast<off_t>(_segment_used))) common::println_warn_loc("Could not truncate segment ", segment_path(_folder, _segment), ": ", std::strerror(errno), '!');
+	::close(_segment_fd);
+
+	_segment_fd = -1;
+	++_segment;
+}
+
+void RawRecordingWriter::append(std::string const& source, std::uint64_t const arrived, std::uint64_t const recorded, RawBuffer const& data) {
+	if (auto const [it, inserted] = _source_ids.try_emplace(source, static_cast<std::uint32_t>(_source_ids.size())); inserted) _sources << source << '\n';
+
+	if (_segment_fd < 0 || _segment_used + data.size() > _segment_capacity) {
+		if (_segment_fd >= 0) close_segment();
+		open_segment(data.size());
+	}
+
+	RawRecordingEntry const entry{arrived, recorded, _segment_used, data.size(), _segment, _source_ids.at(source)};
+
+	if (data.size() >= _buffer.size()) {
+		write_buffer();
+		write_all(_segment_fd, data.data(), data.size());
+	} else {
+		if (_buffered + data.size() > _buffer.size()) write_buffer();
+		std::memcpy(_buffer.data() + _buffered, data.data(), data.size());
+		_buffered += data.size();
+	}
+
+	_segment_used += data.size();
+	_pending_entries.push_back(entry);
+	++_frames;
+}
+
+void RawRecordingWriter::flush() {
+	if (_segment_fd >= 0) write_buffer();
+
+	_index.flush();
+	_sources.flush();
+}
+
+/**
+ * @brief A read-only mapping of a segment file, unmapped when the last frame view is gone.
+ */
+struct RawRecordingReader::MappedSegment {
+	void* data = nullptr;
+	std::size_t size = 0;
+
+	MappedSegment(std::filesystem::path const& path) {
+		int const fd = ::open(path.c_str(), O_RDONLY);
+		if (fd < 0) common::println_critical_loc("Could not open segment ", path, ": ", std::strerror(errno), '!');
+
+		struct stat status{};
+		::fstat(fd, &status);
+		size = static_cast<std::size_t>(status.st_size);
+
+		if (size) {
+			data = ::mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+			if (data == MAP_FAILED) common::println_critical_loc("Could not map segment ", path, ": ", std::strerror(errno), '!');
+
+			// the frames are mostly replayed in the order they were written
+			::madvise(data, size, MADV_SEQUENTIAL);
+		}
+
+		::close(fd);
+	}
+
+	~MappedSegment() {
+		if (data) ::munmap(data, size);
+	}
+
+	MappedSegment(MappedSegment const&) = delete;
+	MappedSegment& operator=(MappedSegment const&) = delete;
+};
+
+RawRecordingReader::RawRecordingReader(std::filesystem::path const& folder) {
+	std::ifstream sources(folder / "sources.txt");
+	for (std::string source; std::getline(sources, source);) _sources.push_back(source);
+
+	for (std::uint32_t segment = 0; std::filesystem::exists(segment_path(folder, segment)); ++segment) _segments.push_back(std::make_shared<MappedSegment const>(segment_path(folder, segment)));
+
+	std::ifstream index(folder / "index.bin", std::ios::binary);
+	RawRecordingIndexHeader header{};
+	if (!index.read(reinterpret_cast<char*>(&header), sizeof(header)) || header.magic != index_magic || header.version != index_version || header.entry_size != sizeof(RawRecordingEntry))
+		common::println_critical_loc("No raw recording found in ", folder, '!');
+
+	auto const bytes = std::filesystem::file_size(folder / "index.bin") - sizeof(header);
+	_entries.resize(bytes / sizeof(RawRecordingEntry));
+	index.read(reinterpret_cast<char*>(_entries.data()), static_cast<std::streamsize>(_entries.size() * sizeof(RawRecordingEntry)));
+
+	// an interrupted recording may end with entries whose segment was not truncated or whose source name was not written yet
+	auto const invalid = std::ranges::remove_if(_entries, [this](RawRecordingEntry const& entry) {
+		return entry.segment >= _segments.size() || entry.offset + entry.length > _segments[entry.segment]->size || entry.source >= _sources.size();
+	});
+	if (!invalid.empty()) common::println_warn_loc("Skipping ", invalid.size(), " incomplete frames of the raw recording in ", folder, '!');
+	_entries.erase(invalid.begin(), invalid.end());
+
+	std::ranges::stable_sort(_entries, {}, &RawRecordingEntry::arrived);
+}
+
+RawBuffer RawRecordingReader::frame(std::size_t const i) const {
+	auto const& entry = _entries[i];
+	auto const& segment = _segments[entry.segment];
+	return RawBuffer(segment, static_cast<std::uint8_t const*>(segment->data) + entry.offset, entry.length);
+}
+
+void RawRecordingReader::prefetch(std::size_t const i) const {
+	if (i >= _entries.size()) return;
+
+	auto const& entry = _entries[i];
+	auto const page_size = static_cast<std::uint64_t>(::sysconf(_SC_PAGESIZE));
+	auto const begin = entry.offset / page_size * page_size;
+	::madvise(static_cast<std::uint8_t*>(_segments[entry.segment]->data) + begin, entry.offset + entry.length - begin, MADV_WILLNEED);
+}
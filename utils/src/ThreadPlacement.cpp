@@ -0,0 +1,133 @@
+#include "ThreadPlacement.h"
+
+#include <sched.h>
+#include <sys/resource.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <mutex>
+#include <sstream>
+
+#include "common_output.h"
+
+struct PlacedThread {
+	std::string name;
+	pthread_t thread;
+	ThreadPlacementConfig requested;
+};
+
+static std::mutex placed_threads_mutex;
+static std::vector<PlacedThread> placed_threads;
+
+static int to_native(SchedulingPolicy const policy) {
+	switch (policy) {
+		case SchedulingPolicy::other: return SCHED_OTHER;
+		case SchedulingPolicy::batch: return SCHED_BATCH;
+		case SchedulingPolicy::idle: return SCHED_IDLE;
+		case SchedulingPolicy::fifo: return SCHED_FIFO;
+		case SchedulingPolicy::round_robin: return SCHED_RR;
+	}
+	return SCHED_OTHER;
+}
+
+static char const* policy_name(int const policy) {
+	switch (policy) {
+		case SCHED_OTHER: return "other";
+		case SCHED_BATCH: return "batch";
+		case SCHED_IDLE: return "idle";
+		case SCHED_FIFO: return "fifo";
+		case SCHED_RR: return "round_robin";
+		default: return "unknown";
+	}
+}
+
+static std::string cpu_list(std::vector<int> const& cpus) {
+	if (cpus.empty()) return "inherited";
+
+	std::ostringstream out;
+	for (std::size_t i = 0; i < cpus.size(); ++i) {
+		std::size_t j = i;
+		while (j + 1 < cpus.size() && cpus[j + 1] == cpus[j] + 1) ++j;
+
+		if (i) out << ',';
+		out << cpus[i];
+		if (j > i) out << '-' << cpus[j];
+		i = j;
+	}
+	return out.str();
+}
+
+static bool apply_affinity_and_scheduling(std::string const& name, pthread_t const thread, ThreadPlacementConfig const& config) {
+	bool ok = true;
+
+	if (!config.cpus.empty()) {
+		cpu_set_t cpu_set;
+		CPU_ZERO(&cpu_set);
+		for (auto const cpu : config.cpus) CPU_SET(cpu, &cpu_set);
+
+		if (int const error = pthread_setaffinity_np(thread, sizeof(cpu_set), &cpu_set); error) {
+			common::println_warn_loc(name, ": could not set cpu affinity to ", cpu_list(config.cpus), ": ", std::strerror(error), '!');
+			ok = false;
+		}
+	}
+
+	int const policy = to_native(config.policy);
+	sched_param param{};
+	param.sched_priority = policy == SCHED_FIFO || policy == SCHED_RR ? std::clamp(config.priority, sched_get_priority_min(policy), sched_get_priority_max(policy)) : 0;
+
+	if (int const error = pthread_setschedparam(thread, policy, &param); error) {
+		common::println_warn_loc(name, ": could not set scheduling policy ", policy_name(policy), " with priority ", param.sched_priority, ": ", std::strerror(error), '!');
+		ok = false;
+	}
+
+	return ok;
+}
+
+bool place_thread(std::string const& name, pthread_t const thread, ThreadPlacementConfig const& config) {
+	bool const ok = apply_affinity_and_scheduling(name, thread, config);
+	if (config.nice) common::println_warn_loc(name, ": the nice value can only be applied from within the thread, use place_this_thread!");
+
+	std::scoped_lock lock(placed_threads_mutex);
+	placed_threads.emplace_back(name, thread, config);
+
+	return ok && !config.nice;
+}
+
+bool place_this_thread(std::string const& name, ThreadPlacementConfig const& config) {
+	bool ok = apply_affinity_and_scheduling(name, pthread_self(), config);
+
+	if (config.nice) {
+		// on linux, the nice value is a per thread attribute if addressed by the thread id
+		if (setpriority(PRIO_PROCESS, static_cast<id_t>(gettid()), config.nice)) {
+			common::println_warn_loc(name, ": could not set nice value ", config.nice, ": ", std::strerror(errno), '!');
+			ok = false;
+		}
+	}
+
+	std::scoped_lock lock(placed_threads_mutex);
+	placed_threads.emplace_back(name, pthread_self(), config);
+
+	return ok;
+}
+
+void print_thread_placement_report() {
+	std::scoped_lock lock(placed_threads_mutex);
+
+	for (auto const& [name, thread, requested] : placed_threads) {
+		std::vector<int> cpus;
+		if (cpu_set_t cpu_set; !pthread_getaffinity_np(thread, sizeof(cpu_set), &cpu_set)) {
+			for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+				if (CPU_ISSET(cpu, &cpu_set)) cpus.push_back(cpu);
+			}
+		}
+
+		int policy = SCHED_OTHER;
+		sched_param param{};
+		pthread_getschedparam(thread, &policy, &param);
+
+		common::println(name, ": cpus ", cpu_list(cpus), " (requested ", cpu_list(requested.cpus), "), policy ", policy_name(policy), " priority ", param.sched_priority, " (requested ", policy_name(to_native(requested.policy)), " priority ",
+		    requested.priority, ")");
+	}
+}
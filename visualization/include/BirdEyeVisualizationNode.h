@@ -6,6 +6,7 @@
 #include "GlobalTrackerResult.h"
 #include "ImageData.h"
 #include "Processor.h"
+#include "Shared.h"
 
 /**
  * @class BirdEyeVisualizationNode
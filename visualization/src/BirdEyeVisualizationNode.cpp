@@ -1,18 +1,23 @@
 #include "BirdEyeVisualizationNode.h"
 
 #include "EigenUtils.h"
+#include "LatencyTracer.h"
 #include "common_literals.h"
 
 using namespace std::chrono_literals;
 
 /**
- * @brief Displays the different road user in the bird's eye view image.
+ * @brief Draws the road users onto a copy of the bird's eye view map.
  *
+ * @param map The bird's eye view map.
+ * @param utm_to_image The affine transformation from UTM coordinates into the map image.
  * @param data The positions of the road users.
  * @return The bird's eye view image with the displayed road user.
  */
-template <>
-ImageData BirdEyeVisualizationNode<CompactObjects>::process(CompactObjects const &data) {
+static ImageData draw_compact_objects(cv::Mat const &map, Eigen::Matrix<double, 4, 4> const &utm_to_image, CompactObjects const &data) {
+	static auto &stage = latency_stage("vis");
+	TraceScope scope(stage, data.trace);
+
 	auto tmp = map.clone();
 	for (auto const &object : data.objects) {
 		cv::Scalar color;
@@ -31,7 +36,29 @@ ImageData BirdEyeVisualizationNode<CompactObjects>::process(CompactObjects const
 		cv::circle(tmp, cv::Point(static_cast<int>(position[0]), static_cast<int>(position[1])), 1, color, 10);
 	}
 
-	return ImageData{tmp, data.timestamp, "bird"};
+	return ImageData{tmp, data.timestamp, "bird", scope.finish(data.timestamp)};
+}
+
+/**
+ * @brief Displays the different road user in the bird's eye view image.
+ *
+ * @param data The positions of the road users.
+ * @return The bird's eye view image with the displayed road user.
+ */
+template <>
+ImageData BirdEyeVisualizationNode<CompactObjects>::process(CompactObjects const &data) {
+	return draw_compact_objects(map, utm_to_image, data);
+}
+
+/**
+ * @brief Displays the different road user in the bird's eye view image.
+ *
+ * @param data The shared positions of the road users.
+ * @return The bird's eye view image with the displayed road user.
+ */
+template <>
+ImageData BirdEyeVisualizationNode<Shared<CompactObjects>>::process(Shared<CompactObjects> const &data) {
+	return draw_compact_objects(map, utm_to_image, *data);
 }
 
 /**
@@ -70,4 +97,8 @@ template class BirdEyeVisualizationNode<GlobalTrackerResults>;
 /**
  * @brief Defines the BirdEyeVisualizationNode class for CompactObjects structure.
  */
-template class BirdEyeVisualizationNode<CompactObjects>;
\ No newline at end of file
+template class BirdEyeVisualizationNode<CompactObjects>;
+/**
+ * @brief Defines the BirdEyeVisualizationNode class for the shared CompactObjects structure.
+ */
+template class BirdEyeVisualizationNode<Shared<CompactObjects>>;
\ No newline at end of file
@@ -1,6 +1,7 @@
 #include <chrono>
 
 #include "CamerasSimulatorNode.h"
+#include "ThreadPlacement.h"
 #include "VideoVisualizationNode.h"
 
 using namespace std::chrono_literals;
@@ -25,5 +26,9 @@ int main(int argc, char* argv[]) {
 	auto cameras_thread = cams();
 	auto video_thread = vid();
 
+	// encoding the video must not steal cycles from the cameras
+	place_thread("video", video_thread, {.cpus = {}, .policy = SchedulingPolicy::idle});
+	print_thread_placement_report();
+
 	std::this_thread::sleep_for(100s);
 }
\ No newline at end of file
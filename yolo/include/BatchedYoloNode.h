@@ -0,0 +1,182 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <deque>
+#include <filesystem>
+#include <functional>
+#include <map>
+#include <optional>
+#include <stop_token>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "BoundedQueue.h"
+#include "Detection2D.h"
+#include "ImageData.h"
+#include "LatencyTracer.h"
+#include "Pusher.h"
+#include "Runner.h"
+#include "Yolo.h"
+#include "YoloNode.h"
+
+/**
+ * @brief Configures how BatchedYoloNode gathers images into a batch.
+ */
+struct YoloBatchingConfig {
+	std::size_t max_batch_size = 4;                                   // the batch is run as soon as it holds this many images, e.g. one per camera
+	std::chrono::nanoseconds window = std::chrono::milliseconds(10);  // the batch is run at the latest this long after its first image arrived
+	std::size_t queue_capacity = 8;                                   // images waiting for the next batch, the producer blocks while the queue is full
+};
+
+/**
+ * @class BatchedYoloNode
+ * @brief Performs the Yolo detection on the images of several cameras in one forward pass.
+ *
+ * The images of one trigger arrive one after another. The node gathers them until the batch is full or the window since the first image elapsed,
+ * runs them as one [B,3,H,W] batch and splits the detections back into one Detections2D per image with the source and the timestamp of that image.
+ * The detections are handed downstream in the order the images arrived, so the order per source is kept for ImageTrackerNode.
+ * Images that MotionGateNode tagged with skip_detection are not put into the batch, they result in empty coasting detections.
+ * The input queue blocks, so a BoundedEdgeNode with OverflowPolicy::latest_per_source should be put in front of the node to drop old images.
+ * @code
+ * BatchedYoloNode<480, 640> yolo(camera_sizes(), model_path(), {.max_batch_size = 4, .window = 10ms});
+ * down.synchronously_connect(yolo.input());
+ * yolo.synchronously_connect(track);
+ * auto yolo_thread = yolo();
+ * @endcode
+ *
+ * @tparam height The height of the scaled image placed in the Yolo detector.
+ * @tparam width The width of the scaled image placed in the Yolo detector.
+ * @tparam device_id The device on which yolo should run.
+ */
+template <int height, int width, int device_id = 0>
+class BatchedYoloNode : public Pusher<Detections2D> {
+   public:
+	using CameraHeightWidthConfig = typename YoloNode<height, width, device_id>::CameraHeightWidthConfig;
+
+   private:
+	class Input : public Runner<ImageData> {
+		BoundedQueue<ImageData>& _queue;
+
+	   public:
+		explicit Input(BoundedQueue<ImageData>& queue) : _queue(queue) {}
+		void run(ImageData const& data) final { _queue.push(data); }
+	};
+
+	std::map<std::string, CameraHeightWidthConfig> const camera_name_height_width;
+	std::filesystem::path const model_path;
+	YoloBatchingConfig const _config;
+
+	BoundedQueue<ImageData> _queue;
+	Input _input;
+	std::deque<Detections2D> _finished;
+	std::optional<std::stop_callback<std::function<void()>>> _close_on_stop;
+
+	/**
+	 * @brief Gathers the next batch, waits for its first image without a timeout.
+	 *
+	 * @return The batch, empty once the node is stopped.
+	 */
+	std::vector<ImageData> gather() {
+		std::vector<ImageData> batch;
+		auto first = _queue.pop();
+		if (!first) return batch;
+		batch.push_back(std::move(*first));
+
+		auto const deadline = std::chrono::steady_clock::now() + _config.window;
+		for (std::size_t detected = !batch.back().skip_detection; detected < _config.max_batch_size;) {
+			auto data = _queue.pop_until(deadline);
+			if (!data) break;
+
+			detected += !data->skip_detection;
+			batch.push_back(std::move(*data));
+		}
+
+		return batch;
+	}
+
+	/**
+	 * @brief Runs the detection on the next batch and queues its results.
+	 */
+	void detect() {
+		static auto& stage = latency_stage("yolo");
+
+		std::vector<ImageData> const batch = gather();
+		if (batch.empty()) return;
+
+		std::deque<TraceScope> scopes;
+		for (auto const& data : batch) scopes.emplace_back(stage, data.trace);
+
+		std::vector<cv::Mat> images;
+		std::vector<std::pair<int, int>> camera_heights_widths;
+		for (auto const& data : batch) {
+			if (data.skip_detection) continue;
+
+			auto const& config = camera_name_height_width.at(data.source);
+			images.push_back(data.image);
+			camera_heights_widths.emplace_back(config.camera_height, config.camera_width);
+		}
+
+		auto objects = run_yolo_batch<height, width, device_id>(images, model_path, camera_heights_widths);
+
+		for (std::size_t i = 0, detected = 0; i < batch.size(); ++i) {
+			Detections2D detections;
+			detections.source = batch[i].source;
+			detections.timestamp = batch[i].timestamp;
+
+			if (batch[i].skip_detection) {
+				detections.coasting = true;
+			} else {
+				auto const& config = camera_name_height_width.at(batch[i].source);
+				detections.objects = std::move(objects[detected++]);
+				for (auto& object : detections.objects) {
+					object.bbox.left += config.offset_left;
+					object.bbox.right += config.offset_left;
+					object.bbox.top += config.offset_top;
+					object.bbox.bottom += config.offset_top;
+				}
+			}
+
+			detections.trace = scopes[i].finish(detections.timestamp);
+			_finished.push_back(std::move(detections));
+		}
+	}
+
+   public:
+	/**
+	 * @param camera_name_height_width A map that maps the names of the cameras connected to this node to the original sizes of these cameras, see YoloNode.
+	 * @param model_path The path of the yolo model. It is loaded into the shared model registry and warmed up for every batch size up to the maximum here.
+	 * @param config The maximum batch size, the gathering window and the capacity of the input queue.
+	 */
+	BatchedYoloNode(std::map<std::string, CameraHeightWidthConfig>&& camera_name_height_width, std::filesystem::path&& model_path, YoloBatchingConfig const& config = {})
+	    : camera_name_height_width(std::forward<decltype(camera_name_height_width)>(camera_name_height_width)),
+	      model_path(std::forward<decltype(model_path)>(model_path)),
+	      _config(config),
+	      _queue(std::max(config.queue_capacity, config.max_batch_size), OverflowPolicy::block),
+	      _input(_queue) {
+		if (!_config.max_batch_size) common::println_critical_loc("The batch size must be at least 1!");
+		warm_up_yolo<height, width, device_id>(this->model_path, _config.max_batch_size);
+	}
+
+	/**
+	 * @brief The node the producer is synchronously connected to.
+	 */
+	Runner<ImageData>& input() { return _input; }
+
+	/**
+	 * @brief Hands the detections of the next image downstream, runs the next batch if none are left.
+	 *
+	 * @return The detections or empty detections once the node is stopped, stopping closes the input queue like BoundedEdgeNode does.
+	 */
+	Detections2D push() final {
+		if (!_close_on_stop) _close_on_stop.emplace(this->stop_token, [this] { _queue.close(); });
+
+		if (_finished.empty()) detect();
+		if (_finished.empty()) return Detections2D{};
+
+		Detections2D ret = std::move(_finished.front());
+		_finished.pop_front();
+		return ret;
+	}
+};
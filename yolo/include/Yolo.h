@@ -1,9 +1,27 @@
 #pragma once
 
+#include <cstddef>
+#include <filesystem>
 #include <opencv2/opencv.hpp>
+#include <utility>
+#include <vector>
 
 #include "Detection2D.h"
 #include "common_output.h"
 
 template <int height, int width, int device_id = 0>
-std::vector<Detection2D> run_yolo(cv::Mat const& downscaled_image, std::filesystem::path const& model_path, int camera_height = height, int camera_width = width);
\ No newline at end of file
+std::vector<Detection2D> run_yolo(cv::Mat const& downscaled_image, std::filesystem::path const& model_path, int camera_height = height, int camera_width = width);
+
+template <int height, int width, int device_id = 0>
+std::vector<std::vector<Detection2D>> run_yolo_batch(std::vector<cv::Mat> const& downscaled_images, std::filesystem::path const& model_path, std::vector<std::pair<int, int>> const& camera_heights_widths);
+
+/**
+ * @brief Loads the yolo model into the model registry and runs dummy batches through it, so that the first frame does not pay for loading and optimizing the model.
+ *
+ * Every model file is loaded, frozen and optimized for inference only once per device it actually runs on. All threads and nodes share this session.
+ *
+ * @param model_path The path of the yolo model.
+ * @param max_batch_size The largest batch size that is warmed up, every smaller one is warmed up as well, e.g. the batch size of BatchedYoloNode.
+ */
+template <int height, int width, int device_id = 0>
+void warm_up_yolo(std::filesystem::path const& model_path, std::size_t max_batch_size = 1);
\ No newline at end of file
@@ -5,6 +5,7 @@
 
 #include "Detection2D.h"
 #include "ImageData.h"
+#include "LatencyTracer.h"
 #include "Processor.h"
 #include "Yolo.h"
 
@@ -22,34 +23,61 @@ class YoloNode : public Processor<ImageData, Detections2D> {
 	    "surfboard", "tennis racket", "bottle", "wine glass", "cup", "fork", "knife", "spoon", "bowl", "banana", "apple", "sandwich", "orange", "broccoli", "carrot", "hot dog", "pizza", "donut", "cake", "chair", "couch", "potted plant",
 	    "bed", "dining table", "toilet", "tv", "laptop", "mouse", "remote", "keyboard", "cell phone", "microwave", "oven", "toaster", "sink", "refrigerator", "book", "clock", "vase", "scissors", "teddy bear", "hair drier", "toothbrush"};
 
+   public:
 	struct CameraHeightWidthConfig {
 		int camera_height;
 		int camera_width;
+		int offset_top = 0;   // top row of the region of interest the image was cropped to, see RegionOfInterestNode
+		int offset_left = 0;  // left column of the region of interest
 	};
 
+   private:
 	std::map<std::string, CameraHeightWidthConfig> const camera_name_height_width;
 	std::filesystem::path const model_path;
 
    public:
 	/**
 	 * @param camera_name_width_height A map that maps the names of the cameras connected to this node to the original sizes of these cameras.
-	 * @param model_path The path of the yolo model.
+	 * If the images are cropped to a region of interest, the size is the size of the crop and the offsets map the detections back to the full frame.
+	 * @param model_path The path of the yolo model. It is loaded into the shared model registry and warmed up here, so the first frame is not delayed.
 	 */
 	explicit YoloNode(std::map<std::string, CameraHeightWidthConfig>&& camera_name_height_width, std::filesystem::path&& model_path)
-	    : camera_name_height_width(std::forward<decltype(camera_name_height_width)>(camera_name_height_width)), model_path(std::forward<decltype(model_path)>(model_path)) {}
+	    : camera_name_height_width(std::forward<decltype(camera_name_height_width)>(camera_name_height_width)), model_path(std::forward<decltype(model_path)>(model_path)) {
+		warm_up_yolo<height, width, device_id>(this->model_path);
+	}
 
 	/**
 	 * @brief Performs a yolo detection.
+	 *
+	 * Images that MotionGateNode tagged with skip_detection are not detected, the result is empty and marked as coasting.
+	 *
 	 * @param data The image data to be used for detection.
 	 * @return The detection result.
 	 */
 	Detections2D process(ImageData const& data) final {
+		static auto& stage = latency_stage("yolo");
+		TraceScope scope(stage, data.trace);
+
 		Detections2D detections;
 		detections.source = data.source;
 		detections.timestamp = data.timestamp;
 
-		detections.objects = run_yolo<height, width, device_id>(data.image, model_path, camera_name_height_width.at(data.source).camera_height, camera_name_height_width.at(data.source).camera_width);
+		if (data.skip_detection) {
+			detections.coasting = true;
+			detections.trace = scope.finish(detections.timestamp);
+			return detections;
+		}
+
+		auto const& config = camera_name_height_width.at(data.source);
+		detections.objects = run_yolo<height, width, device_id>(data.image, model_path, config.camera_height, config.camera_width);
+		for (auto& object : detections.objects) {
+			object.bbox.left += config.offset_left;
+			object.bbox.right += config.offset_left;
+			object.bbox.top += config.offset_top;
+			object.bbox.bottom += config.offset_top;
+		}
 
+		detections.trace = scope.finish(detections.timestamp);
 		return detections;
 	}
 };
\ No newline at end of file
@@ -0,0 +1 @@
+#include "BatchedYoloNode.h"
\ No newline at end of file
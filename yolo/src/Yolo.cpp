@@ -3,6 +3,14 @@
 #include <torch/script.h>
 #include <torch/torch.h>
 
+#include <array>
+#include <chrono>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+
 using torch::indexing::None;
 using torch::indexing::Slice;
 
@@ -106,9 +114,9 @@ torch::Tensor nms(torch::Tensor const& bboxes, torch::Tensor const& scores, floa
  * @param conf_thres The threshold confidence value of a prediction below which the non-maximum suppression is not applied.
  * @param iou_thres The threshold value indicates that the iou overlap with a previous detection is too large and therefore the result of that detection is skipped.
  * @param max_det The value indicates the maximum number of results to be returned. Results with lesser confidence will be skipped.
- * @return The bounding boxes of the resulting detections along with their confidence and object class.
+ * @return The bounding boxes of the resulting detections along with their confidence and object class, one tensor per image of the batch because the number of detections differs.
  */
-torch::Tensor non_max_suppression(torch::Tensor& prediction, float conf_thres = 0.25, float iou_thres = 0.45, int max_det = 300) {
+std::vector<torch::Tensor> non_max_suppression(torch::Tensor& prediction, float conf_thres = 0.25, float iou_thres = 0.45, int max_det = 300) {
 	auto const bs = prediction.size(0);
 	auto nc = prediction.size(1) - 4;
 	auto nm = prediction.size(1) - nc - 4;
@@ -145,7 +153,7 @@ torch::Tensor non_max_suppression(torch::Tensor& prediction, float conf_thres =
 		output[xi] = x.index({i});
 	}
 
-	return torch::stack(output);
+	return output;
 }
 
 /**
@@ -172,66 +180,193 @@ torch::Tensor scale_boxes(torch::Tensor& boxes, int const camera_height, int con
 }
 
 /**
- * @brief Sets up the GPU and loads the yolo model and then performs a yolo inference.
- * @param input_image The downscaled input image.
- * @param camera_height The original height of the camera.
- * @param camera_width The original width of the camera.
+ * @brief A loaded yolo model that is shared by all threads that run it on the same device.
+ */
+struct YoloSession {
+	torch::Device device;
+	torch::jit::script::Module module;
+	std::mutex warm_up_mutex;
+	std::set<std::array<std::int64_t, 3>> warmed_up_shapes;  // batch size, height and width, guarded by warm_up_mutex
+
+	YoloSession(torch::Device const& device, torch::jit::script::Module&& module) : device(device), module(std::move(module)) {}
+};
+
+/**
+ * @brief Returns the session of the model file on the device, the model is loaded, frozen and optimized for inference on the first call.
+ *
+ * TorchScript modules can run forward from several threads at the same time, so one session serves any number of threads.
+ * The sessions are keyed on the device the model actually runs on, so without cuda all device ids share the one cpu session.
+ *
+ * @param model_path The path of the yolo model.
+ * @param device_id The device on which yolo should run.
+ */
+std::shared_ptr<YoloSession> yolo_session(std::filesystem::path const& model_path, int const device_id) {
+	static std::mutex mutex;
+	static std::map<std::pair<std::string, std::string>, std::shared_ptr<YoloSession>> sessions;
+
+	torch::Device const device = torch::cuda::is_available() ? torch::Device(torch::kCUDA, device_id) : torch::Device(torch::kCPU);
+
+	std::scoped_lock lock(mutex);
+	auto& session = sessions[{std::filesystem::weakly_canonical(model_path).string(), device.str()}];
+	if (session) return session;
+
+	auto const start = std::chrono::steady_clock::now();
+
+	torch::jit::script::Module yolo_model = torch::jit::load(model_path, device);
+	yolo_model.eval();
+
+	// freezing inlines the weights as constants, so that optimize_for_inference can fold the batch norms into the convolutions
+	try {
+		yolo_model = torch::jit::freeze(yolo_model);
+		torch::jit::optimize_for_inference(yolo_model);
+	} catch (c10::Error const& e) {
+		common::println_warn_loc("The yolo model ", model_path, " could not be optimized for inference, it runs unoptimized: ", e.what_without_backtrace());
+		yolo_model = torch::jit::load(model_path, device);
+		yolo_model.eval();
+	}
+
+	session = std::make_shared<YoloSession>(device, std::move(yolo_model));
+	common::println(device.is_cuda() ? "GPU mode inference" : "CPU mode inference", ", loaded ", model_path, " in ", std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count(), " s");
+	return session;
+}
+
+/**
+ * @brief Performs a yolo inference on a batch of images with the shared session of the model, the model is loaded if it was not warmed up before.
+ *
+ * All images are stacked into one [B,3,H,W] tensor and passed through the model in one forward pass, which keeps all threads of a cpu busy on the convolutions.
+ *
+ * @param input_images The downscaled input images, either BGR or the CV_32FC1 planes of DownscalingOutput::chw_float.
  * @param model_path The path of the yolo model.
+ * @param camera_heights_widths The original height and width of the camera of every image.
  * @tparam height The height of the scaled image placed in the Yolo detector.
  * @tparam width The width of the scaled image placed in the Yolo detector.
  * @tparam device_id The device on which yolo should run.
+ * @return The detections of every image in the order of the images.
  */
 template <int height, int width, int device_id>
-std::vector<Detection2D> run_yolo(cv::Mat const& input_image, std::filesystem::path const& model_path, int const camera_height, int const camera_width) {
-	thread_local static torch::Device device(torch::cuda::is_available() ? torch::kCUDA : torch::kCPU, device_id);
-	thread_local static torch::jit::script::Module yolo_model = [&model_path] {
-		common::println(torch::cuda::is_available() ? "GPU mode inference" : "CPU mode inference");
-
-		torch::jit::script::Module yolo_model = torch::jit::load(model_path, device);
-		yolo_model.eval();
-
-		return yolo_model;
-	}();
+std::vector<std::vector<Detection2D>> run_yolo_batch(std::vector<cv::Mat> const& input_images, std::filesystem::path const& model_path, std::vector<std::pair<int, int>> const& camera_heights_widths) {
+	if (input_images.empty()) return {};
+
+	auto const session = yolo_session(model_path, device_id);
+	c10::InferenceMode const inference_mode;
+	if (input_images.size() != camera_heights_widths.size()) common::println_critical_loc("Every image of the batch needs the size of its camera!");
+
+	std::vector<torch::Tensor> image_tensors;
+	for (auto const& input_image : input_images) {
+		if (input_image.type() == CV_32FC1) {
+			if (input_image.rows != 3 * height || input_image.cols != width) common::println_critical_loc("The planar input image must be of size 3 * height x width!");
+
+			// already the normalized planar layout of ImageDownscalingNode with DownscalingOutput::chw_float, the blob is used as is
+			image_tensors.push_back(torch::from_blob(input_image.data, {3, height, width}, torch::kFloat32));
+		} else {
+			auto image_tensor = torch::from_blob(input_image.data, {input_image.rows, input_image.cols, 3}, torch::kByte);
+			image_tensors.push_back(image_tensor.toType(torch::kFloat32).div(255).permute({2, 0, 1}));
+		}
+	}
 
-	torch::Tensor image_tensor = torch::from_blob(input_image.data, {input_image.rows, input_image.cols, 3}, torch::kByte).to(device);
-	image_tensor = image_tensor.toType(torch::kFloat32).div(255);
-	image_tensor = image_tensor.permute({2, 0, 1});
-	image_tensor = image_tensor.unsqueeze(0);
-	std::vector<torch::jit::IValue> const inputs{image_tensor};
+	// a single image is only viewed as a batch, so the planar input is still not copied on the cpu
+	torch::Tensor const batch_tensor = image_tensors.size() == 1 ? image_tensors.front().unsqueeze(0).to(session->device) : torch::stack(image_tensors).to(session->device);
+	std::vector<torch::jit::IValue> const inputs{batch_tensor};
 
 	// inference
-	torch::Tensor output = yolo_model.forward(inputs).toTensor().cpu();
+	torch::Tensor output = session->module.forward(inputs).toTensor().cpu();
+
+	auto const batch_keep = non_max_suppression(output);
 
-	auto keep = non_max_suppression(output)[0];
+	std::vector<std::vector<Detection2D>> ret(batch_keep.size());
+	for (std::size_t b = 0; b < batch_keep.size(); ++b) {
+		auto keep = batch_keep[b];
 
-	// scales the boxes
-	auto boxes = keep.index({Slice(), Slice(None, 4)});
-	keep.index_put_({Slice(), Slice(None, 4)}, scale_boxes<height, width>(boxes, camera_height, camera_width));
+		// scales the boxes
+		auto boxes = keep.index({Slice(), Slice(None, 4)});
+		keep.index_put_({Slice(), Slice(None, 4)}, scale_boxes<height, width>(boxes, camera_heights_widths[b].first, camera_heights_widths[b].second));
 
-	std::vector<Detection2D> ret;
-	for (int i = 0; i < keep.size(0); i++) {
-		int const cls = keep[i][5].item().toInt();
-		if (cls != 0 && cls != 1 && cls != 2 && cls != 3 && cls != 5 && cls != 7) continue;
+		for (int i = 0; i < keep.size(0); i++) {
+			int const cls = keep[i][5].item().toInt();
+			if (cls != 0 && cls != 1 && cls != 2 && cls != 3 && cls != 5 && cls != 7) continue;
 
-		BoundingBoxXYXY const bbox{keep[i][0].item().toFloat(), keep[i][1].item().toFloat(), keep[i][2].item().toFloat(), keep[i][3].item().toFloat()};
-		Detection2D const detection2D{bbox, keep[i][4].item().toFloat(), static_cast<std::uint8_t>(cls)};
-		ret.emplace_back(detection2D);
+			BoundingBoxXYXY const bbox{keep[i][0].item().toFloat(), keep[i][1].item().toFloat(), keep[i][2].item().toFloat(), keep[i][3].item().toFloat()};
+			Detection2D const detection2D{bbox, keep[i][4].item().toFloat(), static_cast<std::uint8_t>(cls)};
+			ret[b].emplace_back(detection2D);
+		}
 	}
 
 	return ret;
 }
 
 /**
- * @brief Defines run_yolo function for detector with size 640x640.
+ * @brief Performs a yolo inference on a single image.
+ * @param input_image The downscaled input image, either BGR or the CV_32FC1 planes of DownscalingOutput::chw_float.
+ * @param camera_height The original height of the camera.
+ * @param camera_width The original width of the camera.
+ * @param model_path The path of the yolo model.
+ * @tparam height The height of the scaled image placed in the Yolo detector.
+ * @tparam width The width of the scaled image placed in the Yolo detector.
+ * @tparam device_id The device on which yolo should run.
+ */
+template <int height, int width, int device_id>
+std::vector<Detection2D> run_yolo(cv::Mat const& input_image, std::filesystem::path const& model_path, int const camera_height, int const camera_width) {
+	return std::move(run_yolo_batch<height, width, device_id>({input_image}, model_path, {{camera_height, camera_width}}).front());
+}
+
+/**
+ * @brief Loads the yolo model and runs dummy batches of every size from 1 to max_batch_size through it.
+ *
+ * The first passes of a TorchScript model profile and optimize the graph for the input shape, which takes far longer than a regular inference.
+ * A partial batch of BatchedYoloNode has any size up to the maximum, so every size is warmed up.
+ * Every input shape is warmed up only once per session, no matter how many nodes are constructed with it.
+ *
+ * @param model_path The path of the yolo model.
+ * @param max_batch_size The largest batch size that is run with the model.
+ * @tparam height The height of the scaled image placed in the Yolo detector.
+ * @tparam width The width of the scaled image placed in the Yolo detector.
+ * @tparam device_id The device on which yolo should run.
+ */
+template <int height, int width, int device_id>
+void warm_up_yolo(std::filesystem::path const& model_path, std::size_t const max_batch_size) {
+	auto const session = yolo_session(model_path, device_id);
+	c10::InferenceMode const inference_mode;
+
+	std::scoped_lock lock(session->warm_up_mutex);
+	for (std::int64_t batch_size = 1; batch_size <= static_cast<std::int64_t>(std::max<std::size_t>(max_batch_size, 1)); ++batch_size) {
+		if (!session->warmed_up_shapes.insert({batch_size, height, width}).second) continue;
+
+		auto const start = std::chrono::steady_clock::now();
+		std::vector<torch::jit::IValue> const inputs{torch::full({batch_size, 3, height, width}, 114. / 255., torch::TensorOptions().dtype(torch::kFloat32).device(session->device))};
+		for (int i = 0; i < 3; ++i) session->module.forward(inputs);
+		if (session->device.is_cuda()) torch::cuda::synchronize(session->device.index());
+
+		common::println("warmed up ", model_path, " with batch size ", batch_size, " in ", std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count(), " s");
+	}
+}
+
+/**
+ * @brief Defines run_yolo, run_yolo_batch and warm_up_yolo functions for detector with size 640x640.
  */
 template std::vector<Detection2D> run_yolo<640, 640, 0>(cv::Mat const& input_image, std::filesystem::path const& model_path, int camera_height, int camera_width);
 template std::vector<Detection2D> run_yolo<640, 640, 1>(cv::Mat const& input_image, std::filesystem::path const& model_path, int camera_height, int camera_width);
 template std::vector<Detection2D> run_yolo<640, 640, 2>(cv::Mat const& input_image, std::filesystem::path const& model_path, int camera_height, int camera_width);
 template std::vector<Detection2D> run_yolo<640, 640, 3>(cv::Mat const& input_image, std::filesystem::path const& model_path, int camera_height, int camera_width);
+template std::vector<std::vector<Detection2D>> run_yolo_batch<640, 640, 0>(std::vector<cv::Mat> const& input_images, std::filesystem::path const& model_path, std::vector<std::pair<int, int>> const& camera_heights_widths);
+template std::vector<std::vector<Detection2D>> run_yolo_batch<640, 640, 1>(std::vector<cv::Mat> const& input_images, std::filesystem::path const& model_path, std::vector<std::pair<int, int>> const& camera_heights_widths);
+template std::vector<std::vector<Detection2D>> run_yolo_batch<640, 640, 2>(std::vector<cv::Mat> const& input_images, std::filesystem::path const& model_path, std::vector<std::pair<int, int>> const& camera_heights_widths);
+template std::vector<std::vector<Detection2D>> run_yolo_batch<640, 640, 3>(std::vector<cv::Mat> const& input_images, std::filesystem::path const& model_path, std::vector<std::pair<int, int>> const& camera_heights_widths);
+template void warm_up_yolo<640, 640, 0>(std::filesystem::path const& model_path, std::size_t max_batch_size);
+template void warm_up_yolo<640, 640, 1>(std::filesystem::path const& model_path, std::size_t max_batch_size);
+template void warm_up_yolo<640, 640, 2>(std::filesystem::path const& model_path, std::size_t max_batch_size);
+template void warm_up_yolo<640, 640, 3>(std::filesystem::path const& model_path, std::size_t max_batch_size);
 /**
- * @brief Defines run_yolo function for detector with size 480x640.
+ * @brief Defines run_yolo, run_yolo_batch and warm_up_yolo functions for detector with size 480x640.
  */
 template std::vector<Detection2D> run_yolo<480, 640, 0>(cv::Mat const& input_image, std::filesystem::path const& model_path, int camera_height, int camera_width);
 template std::vector<Detection2D> run_yolo<480, 640, 1>(cv::Mat const& input_image, std::filesystem::path const& model_path, int camera_height, int camera_width);
 template std::vector<Detection2D> run_yolo<480, 640, 2>(cv::Mat const& input_image, std::filesystem::path const& model_path, int camera_height, int camera_width);
-template std::vector<Detection2D> run_yolo<480, 640, 3>(cv::Mat const& input_image, std::filesystem::path const& model_path, int camera_height, int camera_width);
\ No newline at end of file
+template std::vector<Detection2D> run_yolo<480, 640, 3>(cv::Mat const& input_image, std::filesystem::path const& model_path, int camera_height, int camera_width);
+template std::vector<std::vector<Detection2D>> run_yolo_batch<480, 640, 0>(std::vector<cv::Mat> const& input_images, std::filesystem::path const& model_path, std::vector<std::pair<int, int>> const& camera_heights_widths);
+template std::vector<std::vector<Detection2D>> run_yolo_batch<480, 640, 1>(std::vector<cv::Mat> const& input_images, std::filesystem::path const& model_path, std::vector<std::pair<int, int>> const& camera_heights_widths);
+template std::vector<std::vector<Detection2D>> run_yolo_batch<480, 640, 2>(std::vector<cv::Mat> const& input_images, std::filesystem::path const& model_path, std::vector<std::pair<int, int>> const& camera_heights_widths);
+template std::vector<std::vector<Detection2D>> run_yolo_batch<480, 640, 3>(std::vector<cv::Mat> const& input_images, std::filesystem::path const& model_path, std::vector<std::pair<int, int>> const& camera_heights_widths);
+template void warm_up_yolo<480, 640, 0>(std::filesystem::path const& model_path, std::size_t max_batch_size);
+template void warm_up_yolo<480, 640, 1>(std::filesystem::path const& model_path, std::size_t max_batch_size);
+template void warm_up_yolo<480, 640, 2>(std::filesystem::path const& model_path, std::size_t max_batch_size);
+template void warm_up_yolo<480, 640, 3>(std::filesystem::path const& model_path, std::size_t max_batch_size);
\ No newline at end of file
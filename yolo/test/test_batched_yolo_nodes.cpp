@@ -0,0 +1,86 @@
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <map>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "BatchedYoloNode.h"
+#include "ImageDownscalingNode.h"
+#include "YoloNode.h"
+#include "common_output.h"
+
+using namespace std::chrono_literals;
+
+/**
+ * @brief Checks that the batched detections of an image are the detections of the single image.
+ *
+ * The convolutions of a batch may sum in another order than those of a single image, so the scores and the boxes only have to agree closely.
+ */
+bool same_detections(Detections2D const& batched, Detections2D const& single) {
+	if (batched.source != single.source || batched.timestamp != single.timestamp || batched.coasting != single.coasting) return false;
+	if (batched.objects.size() != single.objects.size()) return false;
+
+	for (std::size_t i = 0; i < batched.objects.size(); ++i) {
+		auto const& a = batched.objects[i];
+		auto const& b = single.objects[i];
+		if (a.object_class != b.object_class || std::abs(a.conf - b.conf) > 1e-3) return false;
+		if (std::abs(a.bbox.left - b.bbox.left) > 0.5 || std::abs(a.bbox.top - b.bbox.top) > 0.5 || std::abs(a.bbox.right - b.bbox.right) > 0.5 || std::abs(a.bbox.bottom - b.bbox.bottom) > 0.5) return false;
+	}
+
+	return true;
+}
+
+int main() {
+	std::filesystem::path const model_path = std::filesystem::path(CMAKE_SOURCE_DIR) / "data" / "yolo" / "480x640" / "yolo11m.torchscript";
+	std::map<std::string, std::filesystem::path> const folders = {{"s110_n_cam_8", std::filesystem::path(CMAKE_SOURCE_DIR) / "data" / "tumtraf_v2x_cooperative_perception_dataset" / "train" / "images" / "s110_camera_basler_north_8mm"},
+	    {"s110_o_cam_8", std::filesystem::path(CMAKE_SOURCE_DIR) / "data" / "tumtraf_v2x_cooperative_perception_dataset" / "train" / "images" / "s110_camera_basler_east_8mm"},
+	    {"s110_w_cam_8", std::filesystem::path(CMAKE_SOURCE_DIR) / "data" / "tumtraf_v2x_cooperative_perception_dataset" / "train" / "images" / "s110_camera_basler_south1_8mm"},
+	    {"s110_s_cam_8", std::filesystem::path(CMAKE_SOURCE_DIR) / "data" / "tumtraf_v2x_cooperative_perception_dataset" / "train" / "images" / "s110_camera_basler_south2_8mm"}};
+
+	// the first two images of every camera, the first image of each camera fills one batch, the second images are a partial batch
+	ImageDownscalingNode<480, 640, DownscalingOutput::chw_float> down;
+	std::vector<ImageData> images;
+	std::map<std::string, YoloNode<480, 640>::CameraHeightWidthConfig> sizes;
+	for (std::size_t frame = 0; frame < 2; ++frame) {
+		for (auto const& [camera, folder] : folders) {
+			std::set<std::filesystem::path> files;
+			for (auto const& file : std::filesystem::directory_iterator(folder)) files.insert(file.path());
+			if (files.size() <= frame) common::println_critical_loc("The folder ", folder, " has too few images!");
+
+			cv::Mat const image = cv::imread(std::next(files.begin(), static_cast<std::ptrdiff_t>(frame))->string());
+			sizes.insert_or_assign(camera, YoloNode<480, 640>::CameraHeightWidthConfig{image.rows, image.cols});
+			images.push_back(static_cast<Processor<ImageData, ImageData>&>(down).process(ImageData{image, 1'000'000'000 * (frame + 1), camera, {}}));
+		}
+	}
+
+	// the motion gate lets the detector skip the second image of one camera, which must neither take a slot of the partial batch nor lose its place
+	images[5].skip_detection = true;
+
+	auto single_sizes = sizes;
+	YoloNode<480, 640> yolo(std::move(single_sizes), std::filesystem::path(model_path));
+	BatchedYoloNode<480, 640> batched_yolo(std::move(sizes), std::filesystem::path(model_path), {.max_batch_size = 4, .window = 50ms});
+
+	std::vector<Detections2D> single;
+	for (auto const& image : images) single.push_back(static_cast<Processor<ImageData, Detections2D>&>(yolo).process(image));
+
+	// all images are queued before the first batch is gathered, so the first batch is full and the second one is run when the window elapsed
+	for (auto const& image : images) batched_yolo.input().run(image);
+
+	std::size_t objects = 0;
+	for (std::size_t i = 0; i < images.size(); ++i) {
+		Detections2D const batched = batched_yolo.push();
+		objects += single[i].objects.size();
+
+		if (!same_detections(batched, single[i])) common::println_critical_loc("Batched detections of image ", i, " of ", images[i].source, " differ from the single image detections!");
+	}
+
+	if (!single[5].coasting || !single[5].objects.empty()) common::println_critical_loc("Skipped image did not result in empty coasting detections!");
+	if (!objects) common::println_critical_loc("No objects were detected, the comparison proves nothing!");
+
+	common::println("batched and single image detections agree on ", images.size(), " images with ", objects, " objects");
+}
@@ -5,7 +5,9 @@
 #include "ImagePreprocessingNode.h"
 #include "ImageVisualizationNode.h"
 #include "ProcessorSynchronousPair.h"
+#include "RegionOfInterestNode.h"
 #include "YoloNode.h"
+#include "config.h"
 
 using namespace std::chrono_literals;
 
@@ -43,13 +45,22 @@ int main(int argc, char** argv) {
 	    {"s110_o_cam_8", std::filesystem::path(CMAKE_SOURCE_DIR) / "data" / "tumtraf_v2x_cooperative_perception_dataset" / "val" / "images" / "s110_camera_basler_east_8mm"},
 	    {"s110_w_cam_8", std::filesystem::path(CMAKE_SOURCE_DIR) / "data" / "tumtraf_v2x_cooperative_perception_dataset" / "val" / "images" / "s110_camera_basler_south1_8mm"},
 	    {"s110_s_cam_8", std::filesystem::path(CMAKE_SOURCE_DIR) / "data" / "tumtraf_v2x_cooperative_perception_dataset" / "val" / "images" / "s110_camera_basler_south2_8mm"}});
-	ImageDownscalingNode<480, 640> down;
-	YoloNode<480, 640> yolo(
-	    {{"s110_n_cam_8", {1200, 1920}}, {"s110_s_cam_8", {1200, 1920}}, {"s110_o_cam_8", {1200, 1920}}, {"s110_w_cam_8", {1200, 1920}}}, std::filesystem::path(CMAKE_SOURCE_DIR) / "data" / "yolo" / "480x640" / "yolo11m.torchscript");
+	// the sky and the far distance are cropped away before the inference, the detections are mapped back to the full frame by the yolo node
+	std::map<std::string, RegionOfInterest> const regions = {{"s110_n_cam_8", make_region_of_interest({config::projection_matrix_s110_base_north_into_s110_n_cam_8, 1200, 1920})},
+	    {"s110_s_cam_8", make_region_of_interest({config::projection_matrix_s110_base_north_into_s110_s_cam_8, 1200, 1920})},
+	    {"s110_o_cam_8", make_region_of_interest({config::projection_matrix_s110_base_north_into_s110_o_cam_8, 1200, 1920})},
+	    {"s110_w_cam_8", make_region_of_interest({config::projection_matrix_s110_base_north_into_s110_w_cam_8, 1200, 1920})}};
+	std::map<std::string, YoloNode<480, 640>::CameraHeightWidthConfig> crops;
+	for (auto const& [camera, region] : regions) crops.emplace(camera, YoloNode<480, 640>::CameraHeightWidthConfig{region.crop.height, region.crop.width, region.crop.y, region.crop.x});
+
+	RegionOfInterestNode roi(regions);
+	ImageDownscalingNode<480, 640, DownscalingOutput::chw_float> down;
+	YoloNode<480, 640> yolo(std::move(crops), std::filesystem::path(CMAKE_SOURCE_DIR) / "data" / "yolo" / "480x640" / "yolo11m.torchscript");
 	Detection2DVisualization detvis;
 	ImageVisualizationNode img([](ImageData const& data) { return data.source == "s110_n_cam_8"; });
 
-	cams.asynchronously_connect(down);
+	cams.asynchronously_connect(roi);
+	roi.synchronously_connect(down);
 	down.asynchronously_connect(yolo);
 
 	cams.synchronously_connect(detvis);
@@ -57,7 +68,7 @@ int main(int argc, char** argv) {
 	detvis.synchronously_connect(img);
 
 	auto cams_thread = cams();
-	auto down_thread = down();
+	auto roi_thread = roi();
 	auto yolo_thread = yolo();
 
 	for (auto timestamp = std::chrono::system_clock::now() + 20s; std::chrono::system_clock::now() < timestamp; std::this_thread::yield()) g_main_context_iteration(NULL, true);